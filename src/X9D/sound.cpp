@@ -75,7 +75,7 @@ extern uint8_t CurrentVolume ;
 
 struct t_sound_globals Sound_g ;
 
-struct t_VoiceBuffer VoiceBuffer[3] ;
+struct t_VoiceBuffer VoiceBuffer[NUM_VOICE_BUFFERS] ;
 
 #define SOUND_NONE	0
 #define SOUND_TONE	1
@@ -87,7 +87,7 @@ struct t_VoiceBuffer VoiceBuffer[3] ;
 //int8_t VolumeChanging ;
 //uint8_t VolumeDelay ;
 
-struct t_VoiceBuffer *PtrVoiceBuffer[3] ;
+struct t_VoiceBuffer *PtrVoiceBuffer[NUM_VOICE_BUFFERS] ;
 uint8_t VoiceCount ;
 uint8_t SoundType ;
 uint8_t DacIdle ;
@@ -268,9 +268,12 @@ extern "C" void DMA1_Stream5_IRQHandler()
 	DMA1->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5 ; // Write ones to clear flags
 	if ( Sound_g.VoiceActive == 1 )
 	{
+		uint32_t i ;
 		PtrVoiceBuffer[0]->flags |= VF_SENT ;		// Flag sent
-		PtrVoiceBuffer[0] = PtrVoiceBuffer[1] ;
-		PtrVoiceBuffer[1] = PtrVoiceBuffer[2] ;
+		for ( i = 1 ; i < NUM_VOICE_BUFFERS ; i += 1 )
+		{
+			PtrVoiceBuffer[i-1] = PtrVoiceBuffer[i] ;
+		}
 
 		VoiceCount -= 1 ;
 		if ( VoiceCount == 0 )		// Run out of buffers
@@ -337,7 +340,7 @@ void sound_5ms()
 	{
 		if ( Sound_g.VoiceRequest )
 		{
-			Sound_g.Sound_time = 0 ;						// Remove any pending tone requests
+			mixToneRequest() ;						// Pending tone is mixed with the voice
 			
 			if ( DacIdle )	// All sent
 			{
@@ -364,7 +367,7 @@ void sound_5ms()
 		if ( ( Sound_g.VoiceActive ) || ( ( Voice.VoiceQueueCount ) && sd_card_ready() ) )
 //		if ( Sound_g.VoiceActive )
 		{
-			Sound_g.Sound_time = 0 ;						// Remove any pending tone requests
+			mixToneRequest() ;						// Pending tone is mixed with the voice
 			return ;
 		}
 				
@@ -418,16 +421,48 @@ void sound_5ms()
 }
 
 
+// Converts 4 samples per pass using word loads and stores, src and dest
+// must be word aligned for this, otherwise (and for the tail) 1 at a time
 void wavU8Convert( uint8_t *src, uint16_t *dest , uint32_t count )
 {
+	if ( ( ( (uint32_t)src | (uint32_t)dest ) & 3 ) == 0 )
+	{
+		uint32_t *s = (uint32_t *)src ;
+		uint32_t *d = (uint32_t *)dest ;
+		uint32_t x ;
+		while ( count >= 4 )
+		{
+			x = *s++ ;
+			*d++ = ( ( x & 0x000000FF ) << 4 ) | ( ( x & 0x0000FF00 ) << 12 ) ;
+			*d++ = ( ( x >> 12 ) & 0x00000FF0 ) | ( ( x >> 4 ) & 0x0FF00000 ) ;
+			count -= 4 ;
+		}
+		src = (uint8_t *)s ;
+		dest = (uint16_t *)d ;
+	}
 	while( count-- )
 	{
 		*dest++ = *src++ << 4 ;
 	}
 }
 
+// Signed to offset binary is just flipping the top bit, done for
+// 2 samples in each word
 void wavU16Convert( uint16_t *src, uint16_t *dest , uint32_t count )
 {
+	if ( ( ( (uint32_t)src | (uint32_t)dest ) & 3 ) == 0 )
+	{
+		uint32_t *s = (uint32_t *)src ;
+		uint32_t *d = (uint32_t *)dest ;
+		while ( count >= 4 )
+		{
+			*d++ = ( ( *s++ ^ 0x80008000 ) >> 4 ) & 0x0FFF0FFF ;
+			*d++ = ( ( *s++ ^ 0x80008000 ) >> 4 ) & 0x0FFF0FFF ;
+			count -= 4 ;
+		}
+		src = (uint16_t *)s ;
+		dest = (uint16_t *)d ;
+	}
 	while( count-- )
 	{
 		*dest++ = (uint16_t)( (int16_t )*src++ + 32768) >> 4 ;
@@ -487,18 +522,12 @@ void tone_stop()
 
 void startVoice( uint32_t count )		// count of filled in buffers
 {
+	uint32_t i ;
 	AudioVoiceUnderrun = 0 ;
-	VoiceBuffer[0].flags &= ~VF_SENT ;
-	PtrVoiceBuffer[0] = &VoiceBuffer[0] ;
-	if ( count > 1 )
-	{
-		VoiceBuffer[1].flags &= ~VF_SENT ;
-		PtrVoiceBuffer[1] = &VoiceBuffer[1] ;
-	}
-	if ( count > 2 )
+	for ( i = 0 ; i < count ; i += 1 )
 	{
-		VoiceBuffer[2].flags &= ~VF_SENT ;
-		PtrVoiceBuffer[2] = &VoiceBuffer[2] ;
+		VoiceBuffer[i].flags &= ~VF_SENT ;
+		PtrVoiceBuffer[i] = &VoiceBuffer[i] ;
 	}
 	VoiceCount = count ;
 	Sound_g.VoiceRequest = 1 ;
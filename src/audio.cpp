@@ -459,6 +459,273 @@ void audioVoiceDefevent( uint8_t e, uint8_t v)
 
 
 
+uint16_t VoiceQueueDropped ;
+uint16_t VoiceQueueCoalesced ;
+static uint8_t ReadoutSource ;
+static uint8_t ReadoutJoin ;			// Next readout continues the phrase
+static uint8_t ReadoutBroken ;		// Part of the phrase was dropped, drop the rest
+static uint8_t VoiceHoldJoin ;		// 1 between a volume hold and its restore, 2 if the hold was dropped
+
+// Readouts and info messages play in the order queued
+#define voiceQueuePriority(c)		( ( ((c) & VQ_CLASS_MASK) < VQ_WARNING ) ? 0 : ((c) & VQ_CLASS_MASK) )
+
+// Ring index of queue position i, 0 is the next to play
+static uint32_t voiceQueueSlot( uint32_t i )
+{
+	return ( Voice.VoiceQueueOutIndex + i ) & ( VOICE_Q_LENGTH - 1 ) ;
+}
+
+// Volume hold (0xFF00+volume) or restore (0xFFFF), never dropped
+static uint32_t voiceQueueIsControl( uint32_t i )
+{
+	return ( Voice.VoiceQueue[voiceQueueSlot( i )] & 0xFF00 ) == 0xFF00 ;
+}
+
+static void voiceQueueMove( uint32_t dest, uint32_t src )
+{
+	struct t_voice *vptr ;
+	vptr = &Voice ;
+
+	dest = voiceQueueSlot( dest ) ;
+	src = voiceQueueSlot( src ) ;
+	vptr->VoiceQueue[dest] = vptr->VoiceQueue[src] ;
+	memcpy( vptr->NamedVoiceQueue[dest], vptr->NamedVoiceQueue[src], VOICE_NAME_SIZE+1 ) ;
+	vptr->VoiceQueueClass[dest] = vptr->VoiceQueueClass[src] ;
+	vptr->VoiceQueueSource[dest] = vptr->VoiceQueueSource[src] ;
+}
+
+// Remove queue position i, call with interrupts disabled
+static void voiceQueueRemove( uint32_t i )
+{
+	struct t_voice *vptr ;
+	uint32_t pending ;
+	vptr = &Voice ;
+
+	pending = vptr->VoiceQueueCount - vptr->VoiceTaken ;
+	for ( i += 1 ; i < pending ; i += 1 )
+	{
+		voiceQueueMove( i - 1, i ) ;
+	}
+	vptr->VoiceQueueInIndex = ( vptr->VoiceQueueInIndex - 1 ) & ( VOICE_Q_LENGTH - 1 ) ;
+	vptr->VoiceQueueCount -= 1 ;
+}
+
+// Drop the newest whole unit of a lower priority, call with interrupts
+// disabled. A unit holding a volume control entry, or whose first part is
+// playing, is kept. Returns 0 if there is nothing to drop.
+static uint32_t voiceQueueEvict( uint32_t priority )
+{
+	struct t_voice *vptr ;
+	uint32_t end ;
+	uint32_t start ;
+	uint32_t keep ;
+	uint8_t vclass ;
+	vptr = &Voice ;
+
+	end = vptr->VoiceQueueCount - vptr->VoiceTaken ;
+	while ( end )
+	{
+		start = end - 1 ;
+		keep = 0 ;
+		for (;;)
+		{
+			vclass = vptr->VoiceQueueClass[voiceQueueSlot( start )] ;
+			if ( voiceQueueIsControl( start ) || ( voiceQueuePriority( vclass ) >= priority ) )
+			{
+				keep = 1 ;
+			}
+			if ( ( vclass & VQ_JOINED ) == 0 )
+			{
+				break ;
+			}
+			if ( start == 0 )
+			{
+				keep = 1 ;		// Started playing
+				break ;
+			}
+			start -= 1 ;
+		}
+		if ( keep == 0 )
+		{
+			while ( end > start )
+			{
+				end -= 1 ;
+				voiceQueueRemove( end ) ;
+			}
+			return 1 ;
+		}
+		end = start ;
+	}
+	return 0 ;
+}
+
+// Returns 0 if the entry was dropped
+static uint32_t voiceQueueAdd( const char *name, uint16_t value, uint32_t vclass, uint32_t source )
+{
+	struct t_voice *vptr ;
+	uint32_t pending ;
+	uint32_t priority ;
+	uint32_t i ;
+	uint32_t x ;
+	vptr = &Voice ;
+
+	priority = voiceQueuePriority( vclass ) ;
+	__disable_irq() ;
+	pending = vptr->VoiceQueueCount - vptr->VoiceTaken ;
+	if ( ( ( vclass & VQ_CLASS_MASK ) == VQ_CRITICAL ) && vptr->VoiceTaken && ( vptr->VoicePlayingClass < VQ_CRITICAL ) )
+	{
+		vptr->VoicePreempt = 1 ;
+		// The rest of the unit being cut short goes too, apart from volume control
+		i = 0 ;
+		while ( ( i < pending ) && ( vptr->VoiceQueueClass[voiceQueueSlot( i )] & VQ_JOINED ) )
+		{
+			if ( voiceQueueIsControl( i ) )
+			{
+				i += 1 ;
+			}
+			else
+			{
+				voiceQueueRemove( i ) ;
+				pending -= 1 ;
+			}
+		}
+	}
+	if ( vptr->VoiceQueueCount >= VOICE_Q_LENGTH )
+	{
+		// Full, make room by dropping the newest unit of a lower class
+		VoiceQueueDropped += 1 ;
+		if ( voiceQueueEvict( priority ) == 0 )
+		{
+			__enable_irq() ;
+			return 0 ;
+		}
+		pending = vptr->VoiceQueueCount - vptr->VoiceTaken ;
+	}
+	// Goes behind everything of the same or a higher class
+	for ( i = pending ; i ; i -= 1 )
+	{
+		if ( voiceQueuePriority( vptr->VoiceQueueClass[voiceQueueSlot( i - 1 )] ) >= priority )
+		{
+			break ;
+		}
+	}
+	// and not between the parts of a unit
+	while ( ( i < pending ) && ( vptr->VoiceQueueClass[voiceQueueSlot( i )] & VQ_JOINED ) )
+	{
+		i += 1 ;
+	}
+	for ( x = pending ; x > i ; x -= 1 )
+	{
+		voiceQueueMove( x, x - 1 ) ;
+	}
+	x = voiceQueueSlot( i ) ;
+	if ( name )
+	{
+    memmove( vptr->NamedVoiceQueue[x], name, VOICE_NAME_SIZE ) ;
+	}
+	else
+	{
+		vptr->NamedVoiceQueue[x][0] = '\0' ;
+	}
+	vptr->NamedVoiceQueue[x][VOICE_NAME_SIZE] = '\0' ;
+	vptr->VoiceQueue[x] = value ;
+	vptr->VoiceQueueClass[x] = vclass ;
+	vptr->VoiceQueueSource[x] = source ;
+	vptr->VoiceQueueInIndex = ( vptr->VoiceQueueInIndex + 1 ) & ( VOICE_Q_LENGTH - 1 ) ;
+	vptr->VoiceQueueCount += 1 ;
+	__enable_irq() ;
+	return 1 ;
+}
+
+// Remove the unit at the end of the queue, a readout phrase that couldn't
+// be completed
+static void voiceQueueDropLast()
+{
+	struct t_voice *vptr ;
+	uint32_t pending ;
+	uint8_t vclass ;
+	vptr = &Voice ;
+
+	__disable_irq() ;
+	pending = vptr->VoiceQueueCount - vptr->VoiceTaken ;
+	while ( pending )
+	{
+		pending -= 1 ;
+		vclass = vptr->VoiceQueueClass[voiceQueueSlot( pending )] ;
+		if ( ( vclass & VQ_CLASS_MASK ) != VQ_READOUT )
+		{
+			break ;
+		}
+		voiceQueueRemove( pending ) ;
+		if ( ( vclass & VQ_JOINED ) == 0 )
+		{
+			break ;
+		}
+	}
+	__enable_irq() ;
+}
+
+// Following voice_numeric() calls read out this source, 0 for none. A
+// readout of the same source still waiting to be played is out of date.
+// Everything read out until voiceReadout( 0 ) is one phrase.
+void voiceReadout( uint8_t source )
+{
+	struct t_voice *vptr ;
+	uint32_t i ;
+	uint32_t removed = 0 ;
+	vptr = &Voice ;
+
+	ReadoutSource = source ;
+	ReadoutJoin = 0 ;
+	ReadoutBroken = 0 ;
+	if ( source == 0 )
+	{
+		return ;
+	}
+	__disable_irq() ;
+	// Leave the rest of a phrase that has started playing
+	i = 0 ;
+	while ( ( i < (uint32_t)( vptr->VoiceQueueCount - vptr->VoiceTaken ) )
+					&& ( vptr->VoiceQueueClass[voiceQueueSlot( i )] & VQ_JOINED ) )
+	{
+		i += 1 ;
+	}
+	while ( i < (uint32_t)( vptr->VoiceQueueCount - vptr->VoiceTaken ) )
+	{
+		if ( vptr->VoiceQueueSource[voiceQueueSlot( i )] == source )
+		{
+			voiceQueueRemove( i ) ;
+			removed = 1 ;
+		}
+		else
+		{
+			i += 1 ;
+		}
+	}
+	if ( removed )
+	{
+		VoiceQueueCoalesced += 1 ;
+	}
+	__enable_irq() ;
+}
+
+static void putReadoutQueue( uint16_t value )
+{
+	if ( ReadoutBroken )
+	{
+		return ;
+	}
+	if ( voiceQueueAdd( 0, value, VQ_READOUT | ( ReadoutJoin ? VQ_JOINED : 0 ), ReadoutSource ) == 0 )
+	{
+		if ( ReadoutJoin )
+		{
+			voiceQueueDropLast() ;		// The part already queued
+		}
+		ReadoutBroken = 1 ;
+	}
+	ReadoutJoin = 1 ;
+}
+
 // Announce a value using voice
 void voice_numeric( int16_t value, uint8_t num_decimals, uint8_t units_index )
 {
@@ -466,14 +733,19 @@ void voice_numeric( int16_t value, uint8_t num_decimals, uint8_t units_index )
 	div_t qr ;
 	uint32_t flag = 0 ;
 
+	if ( ReadoutSource == 0 )
+	{
+		ReadoutJoin = 0 ;		// Not inside voiceReadout(), a phrase of its own
+		ReadoutBroken = 0 ;
+	}
 	if ( units_index > 127 )
 	{
-		putVoiceQueue( units_index ) ;
+		putReadoutQueue( units_index ) ;
 	}
 	if ( value < 0 )
 	{
 		value = - value ;
-		putVoiceQueue( V_MINUS ) ;
+		putReadoutQueue( V_MINUS ) ;
 	}
 
 	if ( num_decimals )
@@ -493,34 +765,34 @@ void voice_numeric( int16_t value, uint8_t num_decimals, uint8_t units_index )
 			qr = div( qr.quot, 10 ) ;
 			if ( qr.quot < 21 )
 			{
-				putVoiceQueue( qr.quot + 110 ) ;
+				putReadoutQueue( qr.quot + 110 ) ;
 			}
 			else
 			{
-				putVoiceQueue( qr.quot + 400 ) ;
-				putVoiceQueue( V_THOUSAND ) ;
+				putReadoutQueue( qr.quot + 400 ) ;
+				putReadoutQueue( V_THOUSAND ) ;
 			}
 			qr.quot = qr.rem ;			
 		}
 		if ( qr.quot )		// There are hundreds
 		{
-			putVoiceQueue( qr.quot + 100 ) ;
-			putVoiceQueue( decimals + 400 ) ;
+			putReadoutQueue( qr.quot + 100 ) ;
+			putReadoutQueue( decimals + 400 ) ;
 			flag = 1 ;
 		}
 		else
 		{
-			putVoiceQueue( decimals + 400 ) ;
+			putReadoutQueue( decimals + 400 ) ;
 			flag = 1 ;
 		}
 		if ( ( flag == 0 ) && (qr.rem) )
 		{
-			putVoiceQueue( qr.rem + 400 ) ;
+			putReadoutQueue( qr.rem + 400 ) ;
 		}
 	}
 	else
 	{
-		putVoiceQueue( qr.rem + 400 ) ;
+		putReadoutQueue( qr.rem + 400 ) ;
 	}
 
 	if ( num_decimals )
@@ -528,34 +800,57 @@ void voice_numeric( int16_t value, uint8_t num_decimals, uint8_t units_index )
 		if ( num_decimals == 2 )
 		{
 			qr = div( decimals, 10 ) ;
-			putVoiceQueue( qr.quot + 6 ) ;		// Point x
-			putVoiceQueue( qr.rem + 400 ) ;
+			putReadoutQueue( qr.quot + 6 ) ;		// Point x
+			putReadoutQueue( qr.rem + 400 ) ;
 		}
 		else
 		{
-			putVoiceQueue( decimals + 6 ) ;		// Point x
+			putReadoutQueue( decimals + 6 ) ;		// Point x
 		}
 	}
 		 
 	if ( units_index && ( units_index < 128 ) )
 	{
-		putVoiceQueue( units_index ) ;
+		putReadoutQueue( units_index ) ;
 	}
 }
 
 void putVoiceQueue( uint16_t value )
 {
-	struct t_voice *vptr ;
-	vptr = &Voice ;
-	
-	if ( vptr->VoiceQueueCount < VOICE_Q_LENGTH )
+	if ( ( value & 0xFF00 ) == 0xFF00 )
+	{
+		if ( value != 0xFFFF )
+		{
+			// Volume hold, queued with the message and restore that follow.
+			// Only start if there is room for all three.
+			VoiceHoldJoin = 2 ;
+			if ( Voice.VoiceQueueCount <= VOICE_Q_LENGTH - 3 )
+			{
+				if ( voiceQueueAdd( 0, value, VQ_INFO, 0 ) )
+				{
+					VoiceHoldJoin = 1 ;
+				}
+			}
+			else
+			{
+				VoiceQueueDropped += 1 ;
+			}
+			return ;
+		}
+	}
+	if ( VoiceHoldJoin )
 	{
-		vptr->VoiceQueue[vptr->VoiceQueueInIndex++] = value ;
-		vptr->VoiceQueueInIndex &= ( VOICE_Q_LENGTH - 1 ) ;
-		__disable_irq() ;
-		vptr->VoiceQueueCount += 1 ;
-		__enable_irq() ;
+		if ( VoiceHoldJoin == 1 )
+		{
+			voiceQueueAdd( 0, value, VQ_INFO | VQ_JOINED, 0 ) ;
+		}
+		if ( value == 0xFFFF )
+		{
+			VoiceHoldJoin = 0 ;
+		}
+		return ;
 	}
+	voiceQueueAdd( 0, value, VQ_INFO, 0 ) ;
 }
 
 const char SysVoiceNames[][VOICE_NAME_SIZE+1] =
@@ -616,12 +911,36 @@ const char SysVoiceNames[][VOICE_NAME_SIZE+1] =
 	"CAP_WARN"
 } ;
 
+static uint32_t sysVoiceClass( uint16_t sname )
+{
+	switch ( sname )
+	{
+		case SV_RSSICRIT :
+		case SV_RX_LOST :
+		return VQ_CRITICAL ;
+
+		case SV_SW_WARN :
+		case SV_TH_WARN :
+		case SV_WARNING :
+		case SV_ERROR :
+		case SV_TXBATLOW :
+		case SV_NO_TELEM :
+		case SV_RX_V_LOW :
+		case SV_TEMPWARN :
+		case SV_ALT_WARN :
+		case SV_RSSI_LOW :
+		case SV_CAP_WARN :
+		return VQ_WARNING ;
+	}
+	return VQ_INFO ;
+}
+
 void putSystemVoice( uint16_t sname, uint16_t value )
 {
 	const char *name ;
 
 	name = SysVoiceNames[sname] ;
-	putNamedVoiceQueue( name, 0xE000 + value ) ;
+	voiceQueueAdd( name, 0xE000 + value, sysVoiceClass( sname ), 0 ) ;
 }
 
 void putUserVoice( char *name, uint16_t value )
@@ -631,27 +950,288 @@ void putUserVoice( char *name, uint16_t value )
 
 void putNamedVoiceQueue( const char *name, uint16_t value )
 {
-	struct t_voice *vptr ;
-	vptr = &Voice ;
-	
-	if ( vptr->VoiceQueueCount < VOICE_Q_LENGTH )
-	{
-    memmove(vptr->NamedVoiceQueue[vptr->VoiceQueueInIndex], name, VOICE_NAME_SIZE ) ;
-    vptr->NamedVoiceQueue[vptr->VoiceQueueInIndex][VOICE_NAME_SIZE] = '\0' ;
-		vptr->VoiceQueue[vptr->VoiceQueueInIndex++] = value ; //0xE000 + (value & 0xFFF) ;		// Flag to say use name
-		vptr->VoiceQueueInIndex &= ( VOICE_Q_LENGTH - 1 ) ;
-		__disable_irq() ;
-		vptr->VoiceQueueCount += 1 ;
-		__enable_irq() ;
-	}
+	voiceQueueAdd( name, value, VQ_INFO, 0 ) ;
 }
 
 
 uint8_t SaveVolume ;
 TCHAR VoiceFilename[48] ;
-uint8_t FileData[1024] ;
+uint8_t FileData[1024] __attribute__ ((aligned (4))) ;	// word access in wavU8Convert
 FATFS g_FATFS ;
-FIL Vfile ;
+
+// Voice file being played and the next one, opened while the first plays
+struct t_voiceFile
+{
+	FIL file ;
+	uint32_t size ;				// Sample data bytes left
+	uint32_t frequency ;
+	uint8_t w8or16 ;			// 0 if the file can't be played
+	uint8_t open ;
+	uint8_t slot ;				// Voice queue entry the file is for
+	uint16_t v_index ;
+	uint8_t name[VOICE_NAME_SIZE+1] ;
+} ;
+
+#define VOICE_HEADER_SIZE		320
+
+struct t_voiceFile VoiceFiles[2] ;
+uint8_t VoiceFileIndex ;
+uint8_t VoicePrefetchTried ;
+uint16_t VoicePrefetchHits ;
+uint16_t VoiceLatencyHist[VOICE_LATENCY_BUCKETS] ;
+uint16_t VoiceLatencyMax ;
+const uint8_t VoiceLatencyLimits[VOICE_LATENCY_BUCKETS-1] = { 1, 2, 5, 10 } ;	// 10mS units
+
+// Recently played voice files, so playing one again skips the directory
+// search and the FAT walk. Each has a cluster link map (fast seek) table
+// of VOICE_LINKMAP_SIZE words, enough for a file in 7 fragments
+#ifndef VOICE_CACHE_FILES
+#define VOICE_CACHE_FILES		4
+#endif
+#define VOICE_LINKMAP_SIZE	16
+
+struct t_voiceCache
+{
+	uint16_t v_index ;
+	uint8_t name[VOICE_NAME_SIZE+1] ;
+	WORD id ;							// FatFS mount ID, 0 if entry not in use
+	uint16_t used ;				// For least recently used
+	DWORD sclust ;
+	DWORD fsize ;
+	DWORD linkmap[VOICE_LINKMAP_SIZE] ;
+} ;
+
+struct t_voiceCache VoiceCache[VOICE_CACHE_FILES] ;
+uint16_t VoiceCacheUsed ;
+uint16_t VoiceCacheHits ;
+
+// Index of the .wav files in the voice directories, built when the SD
+// card is mounted, so a file not in VoiceCache is opened with f_reopen()
+// instead of a directory search. Only files found use an entry, kept
+// sorted on a 32 bit hash of the directory and upper case name. A hash
+// shared by two files is marked with sclust 0, those files, and any
+// beyond VOICE_INDEX_SIZE, are opened by name.
+#ifndef VOICE_INDEX_SIZE
+#define VOICE_INDEX_SIZE		192
+#endif
+
+#define VDIR_VOICE				0
+#define VDIR_SYSTEM				1
+#define VDIR_MODELNAMES		2
+#define VDIR_USER					3
+
+struct t_voiceIndex
+{
+	uint32_t hash ;
+	DWORD sclust ;
+	DWORD fsize ;
+} ;
+
+struct t_voiceIndex VoiceIndex[VOICE_INDEX_SIZE] ;
+WORD VoiceIndexId ;				// FatFS mount ID the index was built for
+uint16_t VoiceIndexCount ;
+uint16_t VoiceIndexHits ;
+
+const char * const VoiceDirs[] = { "\\voice", "\\voice\\system", "\\voice\\modelNames", "\\voice\\user" } ;
+
+static uint32_t voiceIndexHash( uint32_t dir, char *name )
+{
+	uint32_t i ;
+	uint32_t hash ;
+
+	hash = ( 2166136261u ^ dir ) * 16777619u ;		// FNV-1a, directory then name
+	for ( i = 0 ; i < VOICE_NAME_SIZE ; i += 1 )
+	{
+		hash ^= (uint8_t)name[i] ;
+		hash *= 16777619u ;
+	}
+	return hash ;
+}
+
+// Position of hash in the index, or where it would be inserted
+static uint32_t voiceIndexPosition( uint32_t hash )
+{
+	uint32_t low ;
+	uint32_t high ;
+	uint32_t mid ;
+
+	low = 0 ;
+	high = VoiceIndexCount ;
+	while ( low < high )
+	{
+		mid = ( low + high ) >> 1 ;
+		if ( VoiceIndex[mid].hash < hash )
+		{
+			low = mid + 1 ;
+		}
+		else
+		{
+			high = mid ;
+		}
+	}
+	return low ;
+}
+
+// Make an index key from a name, stopping at '.' or the end
+static uint32_t voiceIndexName( char *dest, const char *source )
+{
+	uint32_t i ;
+	uint8_t c ;
+
+	for ( i = 0 ; i < VOICE_NAME_SIZE ; i += 1 )
+	{
+		c = *source ;
+		if ( ( c == 0 ) || ( c == '.' ) )
+		{
+			break ;
+		}
+		source += 1 ;
+		if ( ( c >= 'a' ) && ( c <= 'z' ) )
+		{
+			c -= 'a' - 'A' ;
+		}
+		dest[i] = c ;
+	}
+	if ( ( i == 0 ) || ( ( *source != 0 ) && ( *source != '.' ) ) )
+	{
+		return 0 ;		// Empty, or too long to be asked for
+	}
+	while ( i < VOICE_NAME_SIZE )
+	{
+		dest[i++] = ' ' ;
+	}
+	return 1 ;
+}
+
+static uint32_t voiceIndexKey( uint32_t v_index, uint8_t *name, char *key )
+{
+	uint32_t dir ;
+	char number[5] ;
+
+	if ( v_index & 0xF000 )
+	{
+		v_index &= 0xF000 ;
+		dir = VDIR_SYSTEM ;
+		if ( v_index == 0xC000 )
+		{
+			dir = VDIR_MODELNAMES ;
+		}
+		else if ( v_index == 0xD000 )
+		{
+			dir = VDIR_USER ;
+		}
+		if ( ( voiceIndexName( key, (char *)name ) == 0 ) || ( key[0] == ' ' ) )
+		{
+			key[0] = 0 ;			// Not a name that can be indexed
+		}
+	}
+	else
+	{
+		dir = VDIR_VOICE ;
+		number[0] = '0' ;
+		number[1] = '0' + v_index / 100 % 10 ;
+		number[2] = '0' + v_index / 10 % 10 ;
+		number[3] = '0' + v_index % 10 ;
+		number[4] = 0 ;
+		voiceIndexName( key, number ) ;
+	}
+	return dir ;
+}
+
+// Scan the voice directories, called with the card just mounted
+static void buildVoiceIndex()
+{
+	DIR folder ;
+	FILINFO info ;
+	TCHAR lfn[VOICE_NAME_SIZE+5] ;
+	struct t_voiceIndex *vi ;
+	char key[VOICE_NAME_SIZE] ;
+	char *fname ;
+	char *ext ;
+	uint32_t i ;
+	uint32_t hash ;
+	uint32_t pos ;
+
+	VoiceIndexCount = 0 ;
+	VoiceIndexId = 0 ;
+	info.lfname = lfn ;
+	info.lfsize = sizeof(lfn) ;
+	for ( i = 0 ; i < DIM(VoiceDirs) ; i += 1 )
+	{
+		if ( f_opendir( &folder, VoiceDirs[i] ) != FR_OK )
+		{
+			continue ;
+		}
+		VoiceIndexId = folder.id ;
+		while ( ( f_readdir( &folder, &info ) == FR_OK ) && info.fname[0] )
+		{
+			if ( ( info.fattrib & AM_DIR ) || ( info.fclust == 0 ) )
+			{
+				continue ;
+			}
+			fname = lfn[0] ? lfn : info.fname ;
+			ext = strrchr( fname, '.' ) ;
+			if ( ( ext == 0 ) || ( ( ext[1] | 0x20 ) != 'w' ) || ( ( ext[2] | 0x20 ) != 'a' )
+					 || ( ( ext[3] | 0x20 ) != 'v' ) || ( ext[4] != 0 ) || ( voiceIndexName( key, fname ) == 0 ) )
+			{
+				continue ;
+			}
+			hash = voiceIndexHash( i, key ) ;
+			pos = voiceIndexPosition( hash ) ;
+			vi = &VoiceIndex[pos] ;
+			if ( ( pos < VoiceIndexCount ) && ( vi->hash == hash ) )
+			{
+				vi->sclust = 0 ;		// Two names, open either by name
+				continue ;
+			}
+			if ( VoiceIndexCount >= VOICE_INDEX_SIZE )
+			{
+				return ;		// Index full, the rest use f_open()
+			}
+			memmove( vi+1, vi, ( VoiceIndexCount - pos ) * sizeof(struct t_voiceIndex) ) ;
+			VoiceIndexCount += 1 ;
+			vi->hash = hash ;
+			vi->sclust = info.fclust ;
+			vi->fsize = info.fsize ;
+		}
+	}
+}
+
+void buildFilename( uint32_t v_index, uint8_t *name ) ;
+
+// Open a voice file using the index if possible, else by name
+static FRESULT voiceIndexOpen( FIL *file, uint32_t v_index, uint8_t *name )
+{
+	struct t_voiceIndex *vi ;
+	char key[VOICE_NAME_SIZE] ;
+	uint32_t dir ;
+	uint32_t hash ;
+	uint32_t pos ;
+	FRESULT fr ;
+
+	dir = voiceIndexKey( v_index, name, key ) ;
+	if ( VoiceIndexId && key[0] )
+	{
+		hash = voiceIndexHash( dir, key ) ;
+		pos = voiceIndexPosition( hash ) ;
+		vi = &VoiceIndex[pos] ;
+		if ( ( pos < VoiceIndexCount ) && ( vi->hash == hash ) && vi->sclust )
+		{
+			fr = f_reopen( file, vi->sclust, vi->fsize, VoiceIndexId ) ;
+			if ( fr == FR_OK )
+			{
+				VoiceIndexHits += 1 ;
+				return fr ;
+			}
+			if ( fr == FR_NO_FILE )
+			{
+				buildVoiceIndex() ;		// Card has been remounted, open by name this time
+			}
+		}
+	}
+	buildFilename( v_index, name ) ;
+	return f_open( file, VoiceFilename, FA_READ ) ;
+}
 uint32_t SDlastError ;
 
 void buildFilename( uint32_t v_index, uint8_t *name )
@@ -694,18 +1274,369 @@ void buildFilename( uint32_t v_index, uint8_t *name )
 }
 
 
+static uint32_t voiceCacheMatch( struct t_voiceCache *vc, uint32_t v_index, uint8_t *name )
+{
+	if ( ( vc->id == 0 ) || ( vc->v_index != v_index ) )
+	{
+		return 0 ;
+	}
+	if ( v_index & 0xF000 )
+	{
+		return memcmp( vc->name, name, VOICE_NAME_SIZE ) == 0 ;		// Named file
+	}
+	return 1 ;
+}
+
+// Choose an entry for a newly opened file, not one an open file is using
+static struct t_voiceCache *voiceCacheEntry()
+{
+	struct t_voiceCache *vc ;
+	struct t_voiceCache *oldest ;
+	uint32_t i ;
+	uint32_t j ;
+
+	oldest = 0 ;
+	for ( i = 0 ; i < VOICE_CACHE_FILES ; i += 1 )
+	{
+		vc = &VoiceCache[i] ;
+		for ( j = 0 ; j < 2 ; j += 1 )
+		{
+			if ( VoiceFiles[j].open && ( VoiceFiles[j].file.cltbl == vc->linkmap ) )
+			{
+				break ;
+			}
+		}
+		if ( j < 2 )
+		{
+			continue ;		// In use
+		}
+		if ( vc->id == 0 )
+		{
+			return vc ;
+		}
+		if ( ( oldest == 0 ) || ( (uint16_t)( VoiceCacheUsed - vc->used ) > (uint16_t)( VoiceCacheUsed - oldest->used ) ) )
+		{
+			oldest = vc ;
+		}
+	}
+	return oldest ;
+}
+
+// Open a voice file and parse its header, leaving the file at the sample data
+static FRESULT openVoiceFile( struct t_voiceFile *vf, uint32_t v_index, uint8_t *name )
+{
+	FRESULT fr ;
+	UINT nread ;
+	uint32_t offset ;
+	uint32_t size ;
+	uint32_t i ;
+	struct t_voiceCache *vc ;
+
+	vf->w8or16 = 0 ;
+	fr = FR_NO_FILE ;
+	for ( i = 0 ; i < VOICE_CACHE_FILES ; i += 1 )
+	{
+		vc = &VoiceCache[i] ;
+		if ( voiceCacheMatch( vc, v_index, name ) )
+		{
+			fr = f_reopen( &vf->file, vc->sclust, vc->fsize, vc->id ) ;
+			if ( fr == FR_OK )
+			{
+				vf->file.cltbl = vc->linkmap ;
+				vc->used = ++VoiceCacheUsed ;
+				VoiceCacheHits += 1 ;
+			}
+			else
+			{
+				vc->id = 0 ;		// SD card remounted
+			}
+			break ;
+		}
+	}
+	if ( fr != FR_OK )
+	{
+		vc = voiceCacheEntry() ;
+		if ( vc )
+		{
+			vc->id = 0 ;
+			vc->v_index = v_index ;
+			memcpy( vc->name, name, VOICE_NAME_SIZE+1 ) ;
+		}
+		fr = voiceIndexOpen( &vf->file, v_index, name ) ;
+		if ( fr != FR_OK )
+		{
+			if ( (v_index & 0xF000) == 0xE000 )
+			{
+				v_index &= 0x0FFF ;
+				if ( v_index )
+				{
+					fr = voiceIndexOpen( &vf->file, v_index, name ) ;
+				}
+			}
+		}
+		if ( fr != FR_OK )
+		{
+			return fr ;
+		}
+		if ( vc )
+		{
+			// Walk the FAT chain once, later reads use the table
+			vc->linkmap[0] = VOICE_LINKMAP_SIZE ;
+			vf->file.cltbl = vc->linkmap ;
+			if ( f_lseek( &vf->file, CREATE_LINKMAP ) == FR_OK )
+			{
+				vc->id = vf->file.id ;
+				vc->sclust = vf->file.org_clust ;
+				vc->fsize = vf->file.fsize ;
+				vc->used = ++VoiceCacheUsed ;
+			}
+			else
+			{
+				vf->file.cltbl = 0 ;		// Too many fragments
+				vc->id = 0 ;
+			}
+		}
+	}
+	vf->open = 1 ;
+	// Only the header is read here, the file buffer then holds the
+	// start of the sample data for the first fillVoiceBuffer()
+	fr = f_read( &vf->file, FileData, VOICE_HEADER_SIZE, &nread ) ;
+	if ( ( fr != FR_OK ) || ( nread < 44 ) )
+	{
+		return FR_OK ;		// Opened, but nothing to play
+	}
+	size = FileData[34] + ( FileData[35] << 8 ) ;		// sample size
+	if ( ( size != 8 ) && ( size != 16 ) )
+	{
+		return FR_OK ;		// can't convert
+	}
+	vf->frequency = FileData[24] + ( FileData[25] << 8 ) ;		// sample rate
+
+	offset = 39 ;
+	while ( FileData[offset] != 'a' )
+	{
+		size = FileData[offset+1] + ( FileData[offset+2] << 8 ) + ( FileData[offset+3] << 16 ) ;		// data size
+		offset += 8 + size ;
+		if ( offset > 300 )
+		{
+			return FR_OK ;
+		}
+	}
+	vf->size = FileData[offset+1] + ( FileData[offset+2] << 8 ) + ( FileData[offset+3] << 16 ) ;		// data size
+	f_lseek( &vf->file, offset + 5 ) ;
+	vf->w8or16 = FileData[34] ;
+	return FR_OK ;
+}
+
+static void closeVoiceFile( struct t_voiceFile *vf )
+{
+	if ( vf->open )
+	{
+		f_close( &vf->file ) ;
+		vf->open = 0 ;
+	}
+}
+
+// Tones requested while a voice file plays are mixed into the voice buffers
+// here instead of being dropped, the voice is ducked while the tone sounds
+extern uint16_t Sine_values[] ;
+
+static uint8_t MixActive ;
+static uint16_t MixTicks ;			// 10mS periods left
+static uint16_t MixSamples ;		// Samples left in this period
+static uint32_t MixFrequency ;
+static uint32_t MixPhase ;			// Index into Sine_values, 10 bit fraction
+static uint32_t MixStep ;
+
+// Called from sound_5ms() while the voice owns the DAC
+void mixToneRequest()
+{
+	if ( Sound_g.Sound_time && ( Sound_g.MixTime == 0 ) )
+	{
+		Sound_g.MixFreq = Sound_g.Next_freq ;
+		Sound_g.MixIncrement = Sound_g.Next_frequency_increment ;
+		Sound_g.MixTime = ( Sound_g.Sound_time + 9 ) / 10 ;
+		Sound_g.Sound_time = 0 ;
+	}
+}
+
+static void mixToneEnd()
+{
+	MixActive = 0 ;
+	Sound_g.MixTime = 0 ;		// Free for the next request
+}
+
+static void mixTone( uint16_t *dest, uint32_t count, uint32_t rate )
+{
+	int32_t x ;
+	uint32_t n ;
+
+	if ( MixActive == 0 )
+	{
+		if ( Sound_g.MixTime == 0 )
+		{
+			return ;
+		}
+		MixActive = 1 ;
+		MixTicks = Sound_g.MixTime ;
+		MixFrequency = Sound_g.MixFreq ;
+		MixSamples = 0 ;
+		MixPhase = 0 ;
+	}
+	while ( count )
+	{
+		if ( MixSamples == 0 )
+		{
+			if ( MixTicks == 0 )
+			{
+				mixToneEnd() ;
+				return ;
+			}
+			MixTicks -= 1 ;
+			MixSamples = rate / 100 ;
+			MixStep = ( MixFrequency * 100 << 10 ) / rate ;	// 0 => silence
+			MixFrequency += Sound_g.MixIncrement ;
+		}
+		n = ( count < MixSamples ) ? count : MixSamples ;
+		count -= n ;
+		MixSamples -= n ;
+		if ( MixStep == 0 )
+		{
+			dest += n ;
+			continue ;
+		}
+		while ( n-- )
+		{
+			x = ( ( (int32_t)*dest - 2048 ) * MIX_DUCK_GAIN
+					+ ( (int32_t)Sine_values[MixPhase >> 10] - 2048 ) * MIX_TONE_GAIN ) / 16 + 2048 ;
+			if ( x < 0 )
+			{
+				x = 0 ;
+			}
+			else if ( x > 4095 )
+			{
+				x = 4095 ;
+			}
+			*dest++ = x ;
+			MixPhase += MixStep ;
+			while ( MixPhase >= ( 100 << 10 ) )
+			{
+				MixPhase -= 100 << 10 ;
+			}
+		}
+	}
+}
+
+// Read and convert the next block of samples, returns 0 at the end of the file
+static uint32_t fillVoiceBuffer( struct t_voiceFile *vf, uint32_t x )
+{
+	UINT nread ;
+	uint32_t amount ;
+
+	amount = (vf->w8or16 == 8) ? VOICE_BUFFER_SIZE : VOICE_BUFFER_SIZE*2 ;
+	if ( vf->size < amount )
+	{
+		amount = vf->size ;
+	}
+	if ( ( amount == 0 ) || ( f_read( &vf->file, FileData, amount, &nread ) != FR_OK ) )
+	{
+		return 0 ;
+	}
+	vf->size -= nread ;
+	if ( vf->w8or16 == 8 )
+	{
+		wavU8Convert( &FileData[0], VoiceBuffer[x].dataw, nread ) ;
+	}
+	else
+	{
+		nread /= 2 ;
+		wavU16Convert( (uint16_t*)&FileData[0], VoiceBuffer[x].dataw, nread ) ;
+	}
+	mixTone( VoiceBuffer[x].dataw, nread, vf->frequency ? vf->frequency : 16000 ) ;
+	if ( nread == 1 )
+	{
+		nread = 2 ;
+		VoiceBuffer[x].dataw[1] = VoiceBuffer[x].dataw[0] ;
+	}
+	VoiceBuffer[x].count = nread ;
+	VoiceBuffer[x].frequency = vf->frequency ;
+	return nread ;
+}
+
+// While a file plays, open and parse the next queued one
+static void prefetchVoice( uint32_t slot )
+{
+	struct t_voiceFile *vf ;
+	uint32_t v_index ;
+
+	vf = &VoiceFiles[VoiceFileIndex ^ 1] ;
+	if ( vf->open || VoicePrefetchTried || ( Voice.VoiceQueueCount < 2 ) )
+	{
+		return ;
+	}
+	VoicePrefetchTried = 1 ;
+	slot = ( slot + 1 ) & ( VOICE_Q_LENGTH - 1 ) ;
+	v_index = Voice.VoiceQueue[slot] ;
+	if ( (v_index & 0xFF00) == 0xFF00 )
+	{
+		return ;		// Volume change
+	}
+	vf->slot = slot ;
+	vf->v_index = v_index ;
+	memcpy( vf->name, Voice.NamedVoiceQueue[slot], VOICE_NAME_SIZE+1 ) ;
+	if ( openVoiceFile( vf, v_index, Voice.NamedVoiceQueue[slot] ) != FR_OK )
+	{
+		closeVoiceFile( vf ) ;
+	}
+}
+
+static void waitVoiceSent( uint32_t x, uint32_t slot, uint32_t timeout )
+{
+	while ( ( VoiceBuffer[x].flags & VF_SENT ) == 0 )
+	{
+		prefetchVoice( slot ) ;
+		CoTickDelay(1) ;					// 2mS for now
+		if ( timeout )
+		{
+			if ( --timeout == 0 )
+			{
+				break ;
+			}
+		}
+	}
+}
+
+static void voiceLatency( uint16_t start )
+{
+	uint16_t t ;
+	uint32_t i ;
+
+	t = get_tmr10ms() - start ;
+	if ( t > VoiceLatencyMax )
+	{
+		VoiceLatencyMax = t ;
+	}
+	for ( i = 0 ; i < VOICE_LATENCY_BUCKETS - 1 ; i += 1 )
+	{
+		if ( t < VoiceLatencyLimits[i] )
+		{
+			break ;
+		}
+	}
+	VoiceLatencyHist[i] += 1 ;
+}
+
 void voice_task(void* pdata)
 {
 	uint32_t v_index ;
 	FRESULT fr ;
-	UINT nread ;
 	uint32_t x ;
-	uint32_t w8or16 ;
 	uint32_t mounted = 0 ;
-	uint32_t size ;
+	uint32_t slot ;
+	uint32_t last = 0 ;
+	uint16_t start ;
 	uint8_t *name ;
-
-	static uint32_t currentFrequency ;
+	struct t_voiceFile *vf ;
 
 	for(;;)
 	{
@@ -727,6 +1658,10 @@ void voice_task(void* pdata)
 		if ( mounted == 0 )
 		{
   		fr = f_mount(0, &g_FATFS) ;
+			if ( fr == FR_OK )
+			{
+				buildVoiceIndex() ;
+			}
 		}
 		else
 		{
@@ -742,8 +1677,16 @@ void voice_task(void* pdata)
 				CoTickDelay(3) ;					// 6mS for now
 			}
 
-			name = Voice.NamedVoiceQueue[Voice.VoiceQueueOutIndex] ;
-			v_index = Voice.VoiceQueue[Voice.VoiceQueueOutIndex++] ;
+			start = get_tmr10ms() ;
+			__disable_irq() ;
+			slot = Voice.VoiceQueueOutIndex & ( VOICE_Q_LENGTH - 1 ) ;
+			name = Voice.NamedVoiceQueue[slot] ;
+			v_index = Voice.VoiceQueue[slot] ;
+			Voice.VoicePlayingClass = Voice.VoiceQueueClass[slot] & VQ_CLASS_MASK ;
+			Voice.VoiceQueueOutIndex = slot + 1 ;
+			Voice.VoiceTaken = 1 ;
+			Voice.VoicePreempt = 0 ;
+			__enable_irq() ;
 
 			if ( (v_index & 0xFF00) == 0xFF00 )
 			{
@@ -768,179 +1711,85 @@ void voice_task(void* pdata)
 					Voice.VoiceLock = 1 ;
   				CoSchedUnlock() ;
 
-					buildFilename( v_index, name ) ;
-					fr = f_open( &Vfile, VoiceFilename, FA_READ ) ;
-					if ( fr != FR_OK )
+					vf = &VoiceFiles[VoiceFileIndex] ;
+					if ( vf->open && ( vf->slot == slot ) && ( vf->v_index == v_index )
+							 && ( memcmp( vf->name, name, VOICE_NAME_SIZE+1 ) == 0 ) )
 					{
-						if ( (v_index & 0xF000) == 0xE000 )
-						{
-							v_index &= 0x0FFF ;
-							if ( v_index )
-							{
-								buildFilename( v_index, name ) ;
-								fr = f_open( &Vfile, VoiceFilename, FA_READ ) ;
-							}
-						}
+						fr = FR_OK ;		// Opened while the previous file played
+						VoicePrefetchHits += 1 ;
 					}
+					else
+					{
+						closeVoiceFile( vf ) ;
+						fr = openVoiceFile( vf, v_index, name ) ;
+					}
+					VoicePrefetchTried = 0 ;
 					if ( fr == FR_OK )
 					{
-						uint32_t offset ;
-						fr = f_read( &Vfile, FileData, VOICE_BUFFER_SIZE*2, &nread ) ;
-						x = FileData[34] + ( FileData[35] << 8 ) ;		// sample size
-						w8or16 = x ;
-						x = FileData[24] + ( FileData[25] << 8 ) ;		// sample rate
-//						if ( FileData[39] == 'a' )
-//						{
-//							size = FileData[40] + ( FileData[41] << 8 ) + ( FileData[42] << 16 ) ;		// data size
-//							offset = 44 ;
-//						}
-//						else
-//						{
-//							size = FileData[62] + ( FileData[63] << 8 ) + ( FileData[64] << 16 ) ;		// data size
-//							offset = 66 ;
-//						}
-
-						offset = 39 ;
-						while ( FileData[offset] != 'a' )
+						uint32_t started = 0 ;
+						x = 0 ;
+						if ( vf->w8or16 )
 						{
-							size = FileData[offset+1] + ( FileData[offset+2] << 8 ) + ( FileData[offset+3] << 16 ) ;		// data size
-							offset += 8 + size ;
-							if ( offset > 300 )
+							while ( x < NUM_VOICE_BUFFERS )
 							{
-								break ;
+								if ( fillVoiceBuffer( vf, x ) == 0 )
+								{
+									break ;
+								}
+								x += 1 ;
 							}
 						}
-						if ( offset <= 300 )
+						if ( x )
 						{
-							size = FileData[offset+1] + ( FileData[offset+2] << 8 ) + ( FileData[offset+3] << 16 ) ;		// data size
-							offset += 5 ;
-						
-							size -= VOICE_BUFFER_SIZE-offset ;
-							if ( w8or16 == 8 )
-							{
-								wavU8Convert( &FileData[offset], VoiceBuffer[0].dataw, VOICE_BUFFER_SIZE-offset ) ;
-								VoiceBuffer[0].count = VOICE_BUFFER_SIZE-offset ;
-							}
-							else if ( w8or16 == 16 )
-							{
-								wavU16Convert( (uint16_t*)&FileData[offset], VoiceBuffer[0].dataw, VOICE_BUFFER_SIZE-offset/2 ) ;
-								VoiceBuffer[0].count = VOICE_BUFFER_SIZE-offset/2 ;
-								size -= VOICE_BUFFER_SIZE ;
-							}
-							else
-							{
-								w8or16 = 0 ;		// can't convert
-							}
-				
-							if ( w8or16 )
+							startVoice( x ) ;
+							started = 1 ;
+							voiceLatency( start ) ;
+							last = x - 1 ;
+							if ( x >= NUM_VOICE_BUFFERS )
 							{
-								uint32_t amount ;
-								VoiceBuffer[0].frequency = x ;		// sample rate
-								currentFrequency = VoiceBuffer[0].frequency = x ;		// sample rate
-								
-								if ( w8or16 == 8 )
+								for( x = 0 ; vf->size ; )
 								{
-									wavU8Convert( &FileData[VOICE_BUFFER_SIZE], VoiceBuffer[1].dataw, VOICE_BUFFER_SIZE ) ;
-									size -= 512 ;
-								}
-								else
-								{
-									fr = f_read( &Vfile, FileData, VOICE_BUFFER_SIZE*2, &nread ) ;
-									wavU16Convert( (uint16_t*)&FileData[0], VoiceBuffer[1].dataw, VOICE_BUFFER_SIZE ) ;
-									size -= nread ;
-								}
-//								VoiceBuffer[1].count = 512 ;
-								VoiceBuffer[1].count = VOICE_BUFFER_SIZE ;
-					
-//								amount = (w8or16 == 8) ? 512 : 1024 ;
-								amount = (w8or16 == 8) ? VOICE_BUFFER_SIZE : VOICE_BUFFER_SIZE*2 ;
-
-								for ( x = 2 ; x < NUM_VOICE_BUFFERS ; x += 1 )
-								{
-									if ( w8or16 == 8 )
-									{
-										fr = f_read( &Vfile, &FileData[VOICE_BUFFER_SIZE], amount, &nread ) ;		// Read next buffer
-										wavU8Convert( &FileData[VOICE_BUFFER_SIZE], VoiceBuffer[x].dataw, VOICE_BUFFER_SIZE ) ;
-									}
-									else
-									{
-										fr = f_read( &Vfile, &FileData[0], amount, &nread ) ;		// Read next buffer
-										wavU16Convert( (uint16_t *)&FileData[0], VoiceBuffer[x].dataw, VOICE_BUFFER_SIZE ) ;
-									}
-									size -= nread ;
-									VoiceBuffer[x].count = VOICE_BUFFER_SIZE ;
-								}
-								startVoice( NUM_VOICE_BUFFERS ) ;
-								for(x = 0;;)
-								{
-									if ( size < amount )
-									{
-										amount = size ;								
-									}
-									fr = f_read( &Vfile, (uint8_t *)FileData, amount, &nread ) ;		// Read next buffer
-									size -= nread ;
-									if ( nread == 0 )
+									if ( Voice.VoicePreempt )
 									{
-										break ;
-									}
-	  							while ( ( VoiceBuffer[x].flags & VF_SENT ) == 0 )
-									{
-										CoTickDelay(1) ;					// 2mS for now
+										break ;		// Critical message waiting
 									}
+									waitVoiceSent( x, slot, 0 ) ;
 									if ( AudioVoiceUnderrun )
 									{
 										// We weren't quick enough
 										AudioVoiceCountUnderruns += 1 ;
 										AudioVoiceUnderrun = 0 ;
 									}
-									if ( w8or16 == 8 )
-									{
-										wavU8Convert( &FileData[0], VoiceBuffer[x].dataw, nread ) ;
-									}
-									else
-									{
-										nread /= 2 ;
-										wavU16Convert( (uint16_t*)&FileData[0], VoiceBuffer[x].dataw, nread ) ;
-									}
-									if ( nread == 1 )
+									if ( fillVoiceBuffer( vf, x ) == 0 )
 									{
-										nread = 2 ;
-										VoiceBuffer[x].dataw[1] = VoiceBuffer[x].dataw[0] ;
+										break ;
 									}
-									VoiceBuffer[x].count = nread ;
-									VoiceBuffer[x].frequency = currentFrequency ;
 									appendVoice( x ) ;		// index of next buffer
-									v_index = x ;		// Last buffer sent
+									last = x ;		// Last buffer sent
 									x += 1 ;
 									if ( x > NUM_VOICE_BUFFERS - 1 )
 									{
 										x = 0 ;							
 									}
-									if ( (int32_t)size <= 0 )
-									{
-										break ;								
-									}
 								}
 							}
 						}
-						fr = f_close( &Vfile ) ;
-						// Now wait for last buffer to have been sent
-						x = 100 ;
- 						while ( ( VoiceBuffer[v_index].flags & VF_SENT ) == 0 )
+						closeVoiceFile( vf ) ;
+						if ( started )
 						{
-							CoTickDelay(1) ;					// 2mS for now
-							if ( --x == 0 )
-							{
-								break ;		// Timeout, 200 mS
-							}
+							// Now wait for last buffer to have been sent
+							waitVoiceSent( last, slot, 100 ) ;		// Timeout, 200 mS
+							endVoice() ;
 						}
-						endVoice() ;
+						VoiceFileIndex ^= 1 ;		// The prefetched file, if any, is next
 					}
 					else if (fr != FR_NO_FILE)			// There is no file to open
 					{
 						SDlastError = fr ;
 						SdMounted = mounted = 0 ;
+						closeVoiceFile( &VoiceFiles[VoiceFileIndex ^ 1] ) ;
 					}
+					mixToneEnd() ;		// Don't leave part of a tone for the next file
 					Voice.VoiceLock = 0 ;
 				}
 				else
@@ -948,9 +1797,10 @@ void voice_task(void* pdata)
   				CoSchedUnlock() ;
 				}
 			}
-			Voice.VoiceQueueOutIndex &= ( VOICE_Q_LENGTH - 1 ) ;
 			__disable_irq() ;
+			Voice.VoiceQueueOutIndex &= ( VOICE_Q_LENGTH - 1 ) ;
 			Voice.VoiceQueueCount -= 1 ;
+			Voice.VoiceTaken = 0 ;
 			__enable_irq() ;
 		}
 		else
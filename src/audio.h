@@ -212,6 +212,18 @@ void audioVoiceDefevent( uint8_t e, uint8_t v) ;
 
 #define VOICE_Q_LENGTH		16
 
+// Voice queue classes, warnings and critical messages are queued ahead
+// of lower classes and a critical message cuts short the file playing
+#define VQ_READOUT				0
+#define VQ_INFO						1
+#define VQ_WARNING				2
+#define VQ_CRITICAL				3
+#define VQ_CLASS_MASK			0x0F
+// Entry is part of the same unit as the one before it, a readout phrase or
+// a volume hold with its message and restore. Nothing is queued between
+// the parts of a unit and a unit is only dropped whole.
+#define VQ_JOINED					0x80
+
 struct t_voice
 {
 	uint8_t VoiceQueueCount ;
@@ -220,6 +232,11 @@ struct t_voice
 	uint8_t VoiceLock ;
 	uint16_t VoiceQueue[VOICE_Q_LENGTH] ;
 	uint8_t NamedVoiceQueue[VOICE_Q_LENGTH][VOICE_NAME_SIZE+1] ;
+	uint8_t VoiceQueueClass[VOICE_Q_LENGTH] ;
+	uint8_t VoiceQueueSource[VOICE_Q_LENGTH] ;	// Readout source, 0 for none
+	uint8_t VoiceTaken ;				// Entry before VoiceQueueOutIndex is playing
+	uint8_t VoicePlayingClass ;
+	volatile uint8_t VoicePreempt ;	// Stop the file playing
 } ;
 
 extern struct t_voice Voice ;
@@ -228,7 +245,23 @@ extern void putVoiceQueue( uint16_t value ) ;
 extern void putNamedVoiceQueue( const char *name, uint16_t value ) ;
 extern void putSystemVoice( uint16_t sname, uint16_t value ) ;
 extern void putUserVoice( char *name, uint16_t value ) ;
+extern void voiceReadout( uint8_t source ) ;
 extern void voice_task(void* pdata) ;
+extern void mixToneRequest( void ) ;
+
+// Voice start latency, from taking a file from the queue to its first
+// buffer being started, counted in buckets of <10, <20, <50, <100 and
+// >= 100 mS
+#define VOICE_LATENCY_BUCKETS	5
+
+extern uint16_t VoicePrefetchHits ;
+extern uint16_t VoiceQueueDropped ;
+extern uint16_t VoiceQueueCoalesced ;		// Readouts replaced by a newer one
+extern uint16_t VoiceCacheHits ;			// Opened without a directory search
+extern uint16_t VoiceIndexHits ;			// Opened from the voice file index
+extern uint16_t VoiceIndexCount ;			// Files in the voice file index
+extern uint16_t VoiceLatencyHist[] ;
+extern uint16_t VoiceLatencyMax ;		// 10mS units
 
 
 // Defines for voice messages
@@ -0,0 +1,113 @@
+#!/usr/bin/env python
+
+# Convert a binary .blg telemetry log to .csv
+# usage: blog2csv.py logfile.blg [output.csv]
+# See logs.h for the file layout
+
+import sys
+import struct
+
+SECTOR_SIZE = 512
+BINLOG_MAGIC = 0x474F4C45
+SECTOR_MAGIC = 0x4442
+FMT_CHAR = 0x80
+HEADER_SIZE = 24			# t_binLogHeader without format[] and interval[]
+HEADER_SIZE_V1 = 26		# Version 1 header without format[]
+MAX_FIELDS = 48
+
+def formatValue( value, fmt ):
+  if fmt == FMT_CHAR:
+    if value > 32 and value < 127:
+      return chr(value)
+    return ""
+  if fmt == 0:
+    return "%d" % value
+  return "%.*f" % ( fmt, value / float(10 ** fmt) )
+
+filename = sys.argv[1]
+if len(sys.argv) > 2:
+  fileout = sys.argv[2]
+else:
+  fileout = filename.rsplit(".", 1)[0] + ".csv"
+
+fr = open(filename, "rb")
+fw = open(fileout, "w")
+
+header = None
+sector = fr.read(SECTOR_SIZE)
+
+while len(sector) == SECTOR_SIZE:
+  magic = struct.unpack_from("<I", sector, 0)[0]
+  if magic == BINLOG_MAGIC:
+    # New session
+    version = struct.unpack_from("<B", sector, 4)[0]
+    recordSize = 0
+    if version == 1:
+      # Fixed records, every field in every record
+      ( magic, version, numFields, recordSize, interval, year, month, date,
+        hour, minute, second, board ) = struct.unpack_from("<IBBBBHBBBBBB", sector, 0)
+      formats = struct.unpack_from("<%dB" % numFields, sector, HEADER_SIZE_V1)
+      names = sector[HEADER_SIZE_V1+MAX_FIELDS:].split(b"\0")[0].decode("latin-1").split(",")
+    elif version == 2:
+      ( magic, version, numFields, year, month, date,
+        hour, minute, second, board ) = struct.unpack_from("<IBBHBBBBBB", sector, 0)
+      formats = struct.unpack_from("<%dB" % numFields, sector, HEADER_SIZE)
+      names = sector[HEADER_SIZE+2*MAX_FIELDS:].split(b"\0")[0].decode("latin-1").split(",")
+    else:
+      sys.stderr.write("Skipping session with unknown log version %d\n" % version)
+      header = None
+      sector = fr.read(SECTOR_SIZE)
+      continue
+    if names == [""]:
+      names = []
+    while len(names) < numFields:
+      names.append("F%d" % (len(names) + 1))
+    start = ( hour * 60 + minute ) * 60 + second
+    first = None
+    last = 0
+    elapsed = 0
+    masks = ( numFields + 15 ) // 16
+    header = ( version, numFields, masks, recordSize, formats )
+    fw.write("Date,Time,Elapsed," + ",".join(names) + "\n")
+  elif header is not None and struct.unpack_from("<H", sector, 0)[0] == SECTOR_MAGIC:
+    version, numFields, masks, recordSize, formats = header
+    count = struct.unpack_from("<H", sector, 2)[0]
+    offset = 4
+    for r in range(count):
+      if version == 1:
+        if offset + recordSize > SECTOR_SIZE:
+          break
+        tmr10ms = struct.unpack_from("<H", sector, offset)[0]
+        mask = ( 0xFFFF, ) * masks
+        nextRecord = offset + recordSize
+        offset += 2
+      else:
+        # Fields not present in a record are left empty
+        if offset + 2 * ( 1 + masks ) > SECTOR_SIZE:
+          break
+        tmr10ms = struct.unpack_from("<H", sector, offset)[0]
+        mask = struct.unpack_from("<%dH" % masks, sector, offset + 2)
+        offset += 2 * ( 1 + masks )
+      values = []
+      for i in range(numFields):
+        if mask[i >> 4] & ( 1 << ( i & 15 ) ):
+          values.append(formatValue(struct.unpack_from("<h", sector, offset)[0], formats[i]))
+          offset += 2
+        else:
+          values.append("")
+      if version == 1:
+        offset = nextRecord
+      if first is None:
+        first = tmr10ms
+        last = tmr10ms
+      elapsed += ( tmr10ms - last ) & 0xFFFF
+      last = tmr10ms
+      t = start + elapsed // 100
+      fw.write("%04d-%02d-%02d,%02d:%02d:%02d.%02d,%d.%02d," % ( year, month, date,
+                 ( t // 3600 ) % 24, ( t // 60 ) % 60, t % 60, elapsed % 100,
+                 elapsed // 100, elapsed % 100 ))
+      fw.write(",".join(values) + "\n")
+  sector = fr.read(SECTOR_SIZE)
+
+fr.close()
+fw.close()
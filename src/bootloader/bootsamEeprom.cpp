@@ -382,9 +382,85 @@ void AT25D_Read( uint8_t *BufferAddr, uint32_t size, uint32_t memoryOffset)
 }
 
 
+// The firmware stores small changes as delta records after the image in
+// a block, { offset(2), length, checksum, data[length] }, ending at a
+// header of all 0xFF. Apply those falling in this sector, and show the
+// space after the image as erased, so the disk holds what the radio uses.
+static void ee32_apply_deltas( uint32_t sector, uint8_t *buffer )
+{
+	uint8_t header[8] ;
+	uint8_t record[4+252] ;
+	uint32_t block ;
+	uint32_t start ;
+	uint32_t image_end ;
+	uint32_t address ;
+	uint32_t size ;
+	uint32_t offset ;
+	uint32_t length ;
+	uint32_t i ;
+	uint8_t csum ;
+
+	start = sector * 512 ;
+	block = start & ~0x0FFF ;
+	AT25D_Read( header, 8, block ) ;
+	csum = 0 ;
+	for ( i = 0 ; i < 7 ; i += 1 )
+	{
+		csum += header[i] ;
+	}
+	size = header[4] | ( header[5] << 8 ) ;
+	if ( ( csum != header[7] ) || ( size > 4096 - 8 ) )
+	{
+		return ;		// Not a valid block, leave it raw
+	}
+	image_end = block + 8 + size ;
+	for ( i = 0 ; i < 512 ; i += 1 )
+	{
+		if ( start + i >= image_end )
+		{
+			buffer[i] = 0xFF ;
+		}
+	}
+	if ( start >= image_end )
+	{
+		return ;
+	}
+	address = image_end ;
+	while ( address + 4 <= block + 4096 )
+	{
+		AT25D_Read( record, 4, address ) ;
+		offset = record[0] | ( record[1] << 8 ) ;
+		length = record[2] ;
+		// Also stops at the all 0xFF end of the log
+		if ( ( length == 0 ) || ( length > 252 ) || ( offset + length > size ) || ( address + 4 + length > block + 4096 ) )
+		{
+			break ;
+		}
+		AT25D_Read( &record[4], length, address + 4 ) ;
+		csum = record[0] + record[1] + record[2] ;
+		for ( i = 0 ; i < length ; i += 1 )
+		{
+			csum += record[4+i] ;
+		}
+		if ( csum != record[3] )
+		{
+			break ;		// Bad record, the firmware ignores the rest too
+		}
+		for ( i = 0 ; i < length ; i += 1 )
+		{
+			if ( block + 8 + offset + i - start < 512 )
+			{
+				buffer[block + 8 + offset + i - start] = record[4+i] ;
+			}
+		}
+		address += 4 + length ;
+	}
+}
+
 uint32_t ee32_read_512( uint32_t sector, uint8_t *buffer )
 {
 	AT25D_Read( buffer, 512, sector * 512 ) ;
+	ee32_apply_deltas( sector, buffer ) ;
 	return 1 ;
 }
 
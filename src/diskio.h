@@ -170,6 +170,8 @@ extern void sdInit( void ) ;
 #endif
 extern uint32_t sd_card_ready( void ) ;
 extern uint32_t sd_read_block( uint32_t block_no, uint32_t *data ) ;
+extern uint32_t sd_read_blocks( uint32_t block_no, uint32_t *data, uint32_t count ) ;
+extern uint32_t sd_write_blocks( uint32_t block_no, uint32_t *data, uint32_t count ) ;
 
 extern DWORD socket_is_empty( void ) ;
 
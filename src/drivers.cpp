@@ -37,6 +37,7 @@
 #include "lcd.h"
 #include "debug.h"
 #include "frsky.h"
+#include "logs.h"
 #ifndef SIMU
 #include "CoOS.h"
 #endif
@@ -306,6 +307,7 @@ void per10ms()
   g_blinkTmr10ms++;
   uint8_t enuk = KEY_MENU;
   uint8_t    in = ~read_keys() ;
+	RecordKeys = in ;
 	// Bits 3-6 are down, up, right and left
 	// Try to only allow one at a 
 #ifdef REVX
@@ -377,6 +379,7 @@ void per10ms()
 
 
 	in = read_trims() ;
+	RecordTrims = in ;
 
 	for( i=1; i<256; i<<=1)
   {
@@ -1254,6 +1257,44 @@ void rxPdcUsart( void (*pChProcess)(uint8_t x) )
 #endif
 }
 
+// As rxPdcUsart(), but hands over the received data in place,
+// as at most two contiguous blocks when the ring has wrapped
+void rxPdcUsartBlock( void (*pBlockProcess)(uint8_t *p, uint32_t count) )
+{
+#if !defined(SIMU)
+  register Usart *pUsart = SECOND_USART;
+	uint8_t *ptr ;
+	uint8_t *endPtr ;
+
+ //Find out where the DMA has got to
+	endPtr = (uint8_t *)pUsart->US_RPR ;
+	// Check for DMA passed end of buffer
+	if ( endPtr > &TelemetryInBuffer.fifo[RX_UART_BUFFER_SIZE-1] )
+	{
+		endPtr = TelemetryInBuffer.fifo ;
+	}
+	
+	ptr = TelemetryInBuffer.outPtr ;
+	if ( ptr > endPtr )
+	{
+		(*pBlockProcess)( ptr, &TelemetryInBuffer.fifo[RX_UART_BUFFER_SIZE] - ptr ) ;
+		ptr = TelemetryInBuffer.fifo ;
+	}
+	if ( ptr < endPtr )
+	{
+		(*pBlockProcess)( ptr, endPtr - ptr ) ;
+		ptr = endPtr ;
+	}
+	TelemetryInBuffer.outPtr = ptr ;
+
+	if ( pUsart->US_RNCR == 0 )
+	{
+		pUsart->US_RNPR = (uint32_t)TelemetryInBuffer.fifo ;
+		pUsart->US_RNCR = RX_UART_BUFFER_SIZE ;
+	}
+#endif
+}
+
 #ifdef REVX
 void jetiSendWord( uint16_t word )
 {
@@ -105,6 +105,7 @@ extern void poll2ndUsart10mS( void ) ;
 extern void startPdcUsartReceive( void ) ;
 //extern void endPdcUsartReceive( void ) ;
 extern void rxPdcUsart( void (*pChProcess)(uint8_t x) ) ;
+extern void rxPdcUsartBlock( void (*pBlockProcess)(uint8_t *p, uint32_t count) ) ;
 extern uint32_t txPdcUsart( uint8_t *buffer, uint32_t size ) ;
 extern uint32_t txPdcPending( void ) ;
 extern uint32_t txCom2Uart( uint8_t *buffer, uint32_t size ) ;
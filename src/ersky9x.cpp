@@ -35,6 +35,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #ifdef PCBSKY
@@ -75,6 +76,7 @@
 #endif
 
 #include "sbus.h"
+#include "logs.h"
 
 #include "ff.h"
 #include "maintenance.h"
@@ -102,6 +104,8 @@ OS_STK main_stk[MAIN_STACK_SIZE] ;
 uint8_t BtType ;
 OS_TID BtTask;
 OS_STK Bt_stk[BT_STACK_SIZE] ;
+OS_FlagID MixerFlag ;		// Set from the pulse interrupt the mixer lead before a frame
+uint8_t MixerTriggered ;	// main_loop was woken by MixerFlag
 #endif
 OS_TID LogTask;
 OS_STK Log_stk[LOG_STACK_SIZE] ;
@@ -138,6 +142,10 @@ uint8_t CurrentTrainerSource ;
 #define SW_STACK_SIZE	6
 uint8_t Last_switch[NUM_SKYCSW] ;
 int8_t SwitchStack[SW_STACK_SIZE] ;
+// Custom switches already evaluated this frame and their states, cleared
+// around each mixer pass and while the custom switch timers are updated
+uint32_t CsValid ;
+uint32_t CsState ;
 
 //#define TRUE	1
 //#define FALSE	0
@@ -178,6 +186,8 @@ int8_t SwitchStack[SW_STACK_SIZE] ;
 extern uint16_t g_timeMain;
 extern uint16_t g_timeRfsh ;
 extern uint16_t g_timeMixer ;
+extern uint16_t g_timeMixerMax ;
+extern uint16_t g_timeMixerAvg ;
 
 volatile int32_t Rotary_position ;
 volatile int32_t Rotary_count ;
@@ -228,6 +238,7 @@ uint16_t anaIn( uint8_t chan ) ;
 void getADC_single( void ) ;
 void getADC_osmp( void ) ;
 void getADC_filt( void ) ;
+void getADC_chan( void ) ;
 #ifdef PCBSKY
 void read_9_adc( void ) ;
 void init_adc( void ) ;
@@ -1022,6 +1033,7 @@ int main( void )
 
 #ifdef PCBSKY
 	BtTask = CoCreateTask(bt_task,NULL,19,&Bt_stk[BT_STACK_SIZE-1],BT_STACK_SIZE);
+	MixerFlag = CoCreateFlag(TRUE,0) ;
 #endif
 
 	MainTask = CoCreateTask( main_loop,NULL,5,&main_stk[MAIN_STACK_SIZE-1],MAIN_STACK_SIZE);
@@ -1588,6 +1600,7 @@ void bt_task(void* pdata)
 extern const char *openLogs( void ) ;
 extern void writeLogs( void ) ;
 extern void closeLogs( void ) ;
+extern volatile uint8_t LogCloseRequest ;
 
 uint8_t LogsRunning = 0 ;
 uint16_t LogTimer = 0 ;
@@ -1608,6 +1621,19 @@ void log_task(void* pdata)
 		do
 		{
 			CoTickDelay(5) ;					// 10mS
+			if ( LogCloseRequest )
+			{
+				closeLogs() ;		// For another task
+				LogCloseRequest = 0 ;
+			}
+			if ( RecordActive )
+			{
+				flushRecord() ;
+			}
+			if ( BinLogActive )
+			{
+				flushBinLog() ;
+			}
 		} while( (uint16_t)(get_tmr10ms() - tgtime ) < 100 ) ;
 //		LogTimer = 0 ;
   	tgtime += 100 ;
@@ -1857,6 +1883,11 @@ void main_loop(void* pdata)
 
 				refreshDisplay() ;
   		}
+#ifdef PCBSKY
+			// The bootloader USB disk and older firmware only read the plain
+			// images, write out any delta records from this session
+			ee32_compact_all() ;
+#endif
 //			if ( check_soft_power() == 0 )
 //			{
 				lcd_clear() ;
@@ -1889,7 +1920,21 @@ void main_loop(void* pdata)
 //#endif
 		mainSequence( MENUS ) ;
 #ifndef SIMU
-		CoTickDelay(1) ;					// 2mS for now
+#ifdef PCBSKY
+		if ( g_eeGeneral.mixerLead )
+		{
+			// Still every 2mS, but start a pass early when the pulse interrupt
+			// wants the next frame, only building the frame waits for that
+			if ( CoWaitForSingleFlag( MixerFlag, 1 ) == E_OK )
+			{
+				MixerTriggered = 1 ;
+			}
+		}
+		else
+#endif
+		{
+			CoTickDelay(1) ;					// 2mS for now
+		}
 #endif
 	}
 
@@ -2012,11 +2057,41 @@ int8_t getAndSwitch( SKYCSwData &cs )
 #endif
 }
 
+// Alarms sharing a source or a switch read it once per check, custom
+// switches and telemetry scalers are not cheap to evaluate
+#define VAD_SOURCES		(NUM_SKYXCHNRAW+NUM_TELEM_ITEMS+1)
+
+uint16_t VoiceAlarmTime ;			// Last check, 2MHz ticks
+uint16_t VoiceAlarmTimeMax ;
+
+static uint32_t voiceAlarmSwitch( int8_t swtch, uint8_t *states )
+{
+	uint32_t i = swtch + MAX_SKYDRSWITCH ;
+
+	if ( i > MAX_SKYDRSWITCH*2 )
+	{
+		return getSwitch00( swtch ) ;
+	}
+	if ( states[i] == 0 )
+	{
+		states[i] = getSwitch00( swtch ) + 1 ;
+	}
+	return states[i] - 1 ;
+}
+
 static void processVoiceAlarms()
 {
 	uint32_t i ;
+	uint32_t j ;
 	uint32_t curent_state ;
+	static uint8_t sourceAlarm[VAD_SOURCES] ;			// Alarm + 1 that read each source
+	static uint8_t switchStates[MAX_SKYDRSWITCH*2+1] ;	// 0 not read, else state + 1
+	static int16_t values[NUM_VOICE_ALARMS] ;			// Off the main task stack
+	uint16_t t0 = getTmr2MHz() ;
 	VoiceAlarmData *pvad = &g_model.vad[0] ;
+
+	memset( sourceAlarm, 0, sizeof(sourceAlarm) ) ;
+	memset( switchStates, 0, sizeof(switchStates) ) ;
 	for ( i = 0 ; i < NUM_VOICE_ALARMS ; i += 1 )
 	{
 		uint32_t play = 0 ;
@@ -2025,7 +2100,20 @@ static void processVoiceAlarms()
 		{
   		int16_t x ;
 			int16_t y = pvad->offset ;
-			x = getValue( pvad->source - 1 ) ;
+			j = ( pvad->source < VAD_SOURCES ) ? sourceAlarm[pvad->source] : 0 ;
+			if ( j )
+			{
+				x = values[j-1] ;
+			}
+			else
+			{
+				x = getValue( pvad->source - 1 ) ;
+				values[i] = x ;
+				if ( pvad->source < VAD_SOURCES )
+				{
+					sourceAlarm[pvad->source] = i + 1 ;
+				}
+			}
   		switch (pvad->func)
 			{
 				case 1 :
@@ -2065,7 +2153,7 @@ static void processVoiceAlarms()
 // End of invalid telemetry detection
 			if ( pvad->swtch )
 			{
-				if ( getSwitch00( pvad->swtch ) == 0 )
+				if ( voiceAlarmSwitch( pvad->swtch, switchStates ) == 0 )
 				{
 					x = 0 ;
 				}
@@ -2083,7 +2171,7 @@ static void processVoiceAlarms()
 		{
 			if ( pvad->swtch )
 			{
-				curent_state = getSwitch00( pvad->swtch ) ;
+				curent_state = voiceAlarmSwitch( pvad->swtch, switchStates ) ;
 				if ( curent_state == 0 )
 				{
 //							Nvs_state[i] = 0 ;
@@ -2181,7 +2269,9 @@ static void processVoiceAlarms()
 							{
 								int16_t value ;
 								value = getValue( pvad->source - 1 ) ;
+								voiceReadout( pvad->source ) ;
 								voice_numeric( value, 0, 0 ) ;
+								voiceReadout( 0 ) ;
 							}
 						}
 					}
@@ -2233,7 +2323,9 @@ static void processVoiceAlarms()
 							{
 								int16_t value ;
 								value = getValue( pvad->source - 1 ) ;
+								voiceReadout( pvad->source ) ;
 								voice_numeric( value, 0, 0 ) ;
+								voiceReadout( 0 ) ;
 							}
 						}
 					}
@@ -2262,11 +2354,18 @@ static void processVoiceAlarms()
 		}
 		pvad += 1 ;
 	}
+	t0 = getTmr2MHz() - t0 ;
+	VoiceAlarmTime = t0 ;
+	if ( t0 > VoiceAlarmTimeMax )
+	{
+		VoiceAlarmTimeMax = t0 ;
+	}
 }
 
 
 uint32_t MixerRate ;
 uint32_t MixerCount ;
+uint32_t MixerTimeSum ;		// 2MHz ticks spent in the mixer this second
 
 uint8_t AlarmTimers[NUM_SKYCHNOUT] ;
 
@@ -2279,6 +2378,9 @@ void mainSequence( uint32_t no_menu )
 #endif
   uint16_t t0 = getTmr2MHz();
 	uint8_t numSafety = NUM_SKYCHNOUT - g_model.numVoice ;
+#ifdef PCBSKY
+	MixerInputTime = t0 ;		// Inputs read now, for the latency to the pulses
+#endif
 	
 	if ( g_eeGeneral.filterInput == 1 )
 	{
@@ -2288,6 +2390,10 @@ void mainSequence( uint32_t no_menu )
 	{
 		getADC_filt() ;
 	}
+	else if ( g_eeGeneral.filterInput == 3 )
+	{
+		getADC_chan() ;
+	}
 	else
 	{
 		getADC_single() ;
@@ -2368,7 +2474,12 @@ void mainSequence( uint32_t no_menu )
 				StickScrollTimer -= 1 ;				
 			}
 			MixerRate = MixerCount ;
+			if ( MixerCount )
+			{
+				g_timeMixerAvg = MixerTimeSum / MixerCount ;
+			}
 			MixerCount = 0 ;
+			MixerTimeSum = 0 ;
 		}
 #ifndef SIMU
  #ifdef PCBSKY
@@ -2813,6 +2924,8 @@ static uint8_t RssiTestCount ;
   	  	SKYCSwData &cs = g_model.customSw[i];
   	  	uint8_t cstate = CS_STATE(cs.func);
 
+				CsValid = 0 ;		// States change as we go
+
   	  	if(cstate == CS_TIMER)
 				{
 					int16_t y ;
@@ -2996,6 +3109,7 @@ static uint8_t RssiTestCount ;
 					}
 				}
 			}
+			CsValid = 0 ;
 		}
 
 		// Now also check for resetting timers
@@ -3874,6 +3988,36 @@ int8_t getGvarSourceValue( uint8_t src )
  	return value ;
 }
 
+#ifdef PCBSKY
+// With a mixer lead set the next pulse frame is only built on the pass the
+// pulse interrupt asked for. The mixer itself, and everything stepped by
+// tick10ms, still runs every pass.
+static uint32_t pulsesDue()
+{
+	if ( g_eeGeneral.mixerLead == 0 )
+	{
+		return 1 ;
+	}
+#ifndef SIMU
+	if ( MixerTriggered == 0 )
+	{
+		if ( CoAcceptSingleFlag( MixerFlag ) == E_OK )
+		{
+			MixerTriggered = 1 ;
+		}
+	}
+#else
+	MixerTriggered = 1 ;
+#endif
+	if ( MixerTriggered )
+	{
+		MixerTriggered = 0 ;
+		return 1 ;
+	}
+	return 0 ;		// The interrupt builds the frame itself if this is late
+}
+#endif
+
 void perMain( uint32_t no_menu )
 {
   static uint16_t lastTMR;
@@ -3888,10 +4032,23 @@ void perMain( uint32_t no_menu )
 	{
 		MixerCount += 1 ;		
 		uint16_t t1 = getTmr2MHz() ;
+		CsValid = 0 ;
 		perOutPhase(g_chans512, 0);
+		CsValid = 0 ;			// Outputs have changed
 		t1 = getTmr2MHz() - t1 ;
 		g_timeMixer = t1 ;
+		MixerTimeSum += t1 ;
+		if ( t1 > g_timeMixerMax )
+		{
+			g_timeMixerMax = t1 ;		// Worst case, cleared from the statistics menu
+		}
+	}
+#ifdef PCBSKY
+	if ( pulsesDue() )
+	{
+		buildPulses() ;		// Next frame from these outputs, the interrupt only swaps to it
 	}
+#endif
 
 	if(tick5ms)
 	{
@@ -3901,6 +4058,15 @@ void perMain( uint32_t no_menu )
 
 	if(!tick10ms) return ; //make sure the rest happen only every 10ms.
 
+	if ( RecordActive )
+	{
+		recordFrame() ;
+	}
+	if ( BinLogActive )
+	{
+		binLogSample() ;
+	}
+
 	if ( ppmInValid )
 	{
 		ppmInValid -= 1 ;
@@ -4651,6 +4817,126 @@ void getADC_filt()
 }
 
 
+// Per channel filtering, one read each pass like SINGLE so nothing more
+// blocks, with each input filtered to suit it. Sticks get a short moving
+// average, pots lose single read spikes and the battery is smoothed hard.
+#define ANA_FILT_NONE		0
+#define ANA_FILT_AVG		1		// Average of the last 4 reads
+#define ANA_FILT_IIR		2		// 1 pole, 1/16 of each read
+#define ANA_FILT_MEDIAN	3		// Median of the last 3 reads, then 1/4 of each
+
+const uint8_t AnaFilterType[NUMBER_ANALOG+NUM_EXTRA_ANALOG] =
+{
+	ANA_FILT_AVG, ANA_FILT_AVG, ANA_FILT_AVG, ANA_FILT_AVG,		// Sticks
+#ifdef PCBSKY
+	ANA_FILT_MEDIAN, ANA_FILT_MEDIAN, ANA_FILT_MEDIAN,				// Pots
+	ANA_FILT_IIR,																							// Battery
+#if NUMBER_ANALOG > 8
+	ANA_FILT_IIR,																							// Current
+	ANA_FILT_MEDIAN
+#endif
+#endif
+#ifdef PCBX9D
+	ANA_FILT_MEDIAN, ANA_FILT_MEDIAN, ANA_FILT_MEDIAN, ANA_FILT_MEDIAN,	// Pots and sliders
+	ANA_FILT_IIR,																							// Battery
+#if NUMBER_ANALOG > 9
+	ANA_FILT_MEDIAN,
+#endif
+#if NUM_EXTRA_ANALOG > 0
+	ANA_FILT_MEDIAN, ANA_FILT_MEDIAN, ANA_FILT_MEDIAN
+#endif
+#endif
+} ;
+
+void getADC_chan()
+{
+	register uint32_t x ;
+	uint32_t temp ;
+	uint32_t index ;
+	static uint16_t history[NUMBER_ANALOG+NUM_EXTRA_ANALOG][4] ;
+	static uint16_t sum[NUMBER_ANALOG+NUM_EXTRA_ANALOG] ;
+	static uint16_t acc[NUMBER_ANALOG+NUM_EXTRA_ANALOG] ;
+	static uint8_t hindex ;
+	static uint16_t lastTime ;
+	uint32_t prime ;
+
+#ifdef PCBSKY
+	read_9_adc() ;
+#endif
+#ifdef PCBX9D
+	read_adc() ;
+#endif
+	// Start again from this read if not called for a while (mode changed)
+	prime = ( (uint16_t)( get_tmr10ms() - lastTime ) > 10 ) ;
+	lastTime = get_tmr10ms() ;
+	index = hindex = ( hindex + 1 ) & 3 ;
+
+	for( x = 0 ; x < NUMBER_ANALOG+NUM_EXTRA_ANALOG ; x += 1 )
+	{
+		temp = Analog_values[x] ;
+#ifdef PCBX9D
+		if ( (x==1) || (x==3) )
+		{
+			temp = 4096 - temp ;
+		}
+#endif
+		if ( prime )
+		{
+			uint16_t *p = history[x] ;
+			p[0] = p[1] = p[2] = p[3] = temp ;
+			sum[x] = temp * 4 ;
+			acc[x] = ( AnaFilterType[x] == ANA_FILT_IIR ) ? temp << 4 : temp << 2 ;
+		}
+		switch ( AnaFilterType[x] )
+		{
+			case ANA_FILT_AVG :
+				sum[x] += temp - history[x][index] ;
+				history[x][index] = temp ;
+				temp = sum[x] >> 3 ;
+			break ;
+
+			case ANA_FILT_IIR :
+				acc[x] += temp - ( acc[x] >> 4 ) ;
+				temp = acc[x] >> 5 ;
+			break ;
+
+			case ANA_FILT_MEDIAN :
+			{
+				uint16_t *p = history[x] ;
+				uint32_t a ;
+				uint32_t b ;
+				p[index] = temp ;		// Newest 3 of the 4 kept
+				a = p[(index-1) & 3] ;
+				b = p[(index-2) & 3] ;
+				if ( a > b )
+				{
+					uint32_t c = a ;
+					a = b ;
+					b = c ;
+				}
+				// a <= b, median is temp clamped to a..b
+				if ( temp < a )
+				{
+					temp = a ;
+				}
+				else if ( temp > b )
+				{
+					temp = b ;
+				}
+				acc[x] += temp - ( acc[x] >> 2 ) ;
+				temp = acc[x] >> 3 ;
+			}
+			break ;
+
+			default :
+				temp >>= 1 ;
+			break ;
+		}
+		S_anaFilt[x] = temp ;
+	}
+}
+
+
 uint32_t getFlightPhase()
 {
 	uint32_t i ;
@@ -5427,6 +5713,15 @@ bool getSwitch(int8_t swtch, bool nc, uint8_t level)
 	
 	cs_index = aswitch-(MAX_SKYDRSWITCH-NUM_SKYCSW);
 
+	if ( ( aswitch >= MAX_SKYDRSWITCH-NUM_SKYCSW ) && ( aswitch < MAX_SKYDRSWITCH ) )
+	{
+		if ( CsValid & ( 1 << cs_index ) )
+		{ // Already evaluated this frame
+			ret_value = ( CsState >> cs_index ) & 1 ;
+	    return swtch>0 ? ret_value : !ret_value ;
+		}
+	}
+
 	{
 		int32_t index ;
 		for ( index = level - 1 ; index >= 0 ; index -= 1 )
@@ -5649,6 +5944,15 @@ bool getSwitch(int8_t swtch, bool nc, uint8_t level)
 	{
 		Last_switch[cs_index] = ret_value ;
 	}
+	CsValid |= 1 << cs_index ;
+	if ( ret_value )
+	{
+		CsState |= 1 << cs_index ;
+	}
+	else
+	{
+		CsState &= ~( 1 << cs_index ) ;
+	}
 	return swtch>0 ? ret_value : !ret_value ;
 
 }
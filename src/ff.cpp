@@ -739,6 +739,34 @@ FRESULT put_fat (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Convert offset into cluster with link map table        */
+/*-----------------------------------------------------------------------*/
+#if _USE_FASTSEEK
+static
+DWORD clmt_clust (	/* <2:Error, >=2:Cluster number */
+	FIL* fp,		/* Pointer to the file object */
+	DWORD ofs		/* File offset to be converted to cluster# */
+)
+{
+	DWORD cl, ncl, *tbl;
+
+
+	tbl = fp->cltbl + 1;	/* Top of CLMT */
+	cl = ofs / SS(fp->fs) / fp->fs->csize;	/* Cluster order from top of the file */
+	for (;;) {
+		ncl = *tbl++;			/* Number of cluters in the fragment */
+		if (!ncl) return 0;		/* End of table? (error) */
+		if (cl < ncl) break;	/* In this fragment? */
+		cl -= ncl; tbl++;		/* Next fragment */
+	}
+	return cl + *tbl;	/* Return the cluster number */
+}
+#endif	/* _USE_FASTSEEK */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* FAT handling - Remove a cluster chain                                 */
 /*-----------------------------------------------------------------------*/
@@ -1674,6 +1702,9 @@ void get_fileinfo (		/* No return code */
 		fno->fsize = LD_DWORD(dir+DIR_FileSize);	/* Size */
 		fno->fdate = LD_WORD(dir+DIR_WrtDate);		/* Date */
 		fno->ftime = LD_WORD(dir+DIR_WrtTime);		/* Time */
+#if _USE_FASTSEEK
+		fno->fclust = LD_CLUST(dir);				/* Start cluster, for f_reopen() */
+#endif
 	}
 	*p = 0;		/* Terminate SFN str by a \0 */
 
@@ -2192,6 +2223,51 @@ FRESULT f_open (
 
 
 
+#if _USE_FASTSEEK
+/*-----------------------------------------------------------------------*/
+/* Reopen a File                                                         */
+/*-----------------------------------------------------------------------*/
+/* Open a file for reading from the start cluster and size taken from a
+   file object opened earlier on the same mount, skipping the directory
+   search. The cluster link map is not kept, set cltbl again if needed. */
+
+FRESULT f_reopen (
+	FIL *fp,			/* Pointer to the blank file object */
+	DWORD sclust,		/* File start cluster, org_clust of the earlier file */
+	DWORD fsize,		/* File size */
+	WORD id				/* Mount ID of the earlier file object */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	const TCHAR *path = _T("");
+
+
+	fp->fs = 0;			/* Clear file object */
+	res = chk_mounted(&path, &fs, 0);
+	if (res == FR_OK && fs->id != id)	/* Volume has been remounted since */
+		res = FR_NO_FILE;
+	if (res == FR_OK) {
+		fp->flag = FA_READ;
+		fp->org_clust = sclust;
+		fp->fsize = fsize;
+		fp->fptr = 0;
+		fp->dsect = 0;
+#if !_FS_READONLY
+		fp->dir_sect = 0;
+		fp->dir_ptr = 0;
+#endif
+		fp->cltbl = 0;
+		fp->fs = fs; fp->id = fs->id;	/* Validate file object */
+	}
+
+	LEAVE_FF(fs, res);
+}
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Read File                                                             */
 /*-----------------------------------------------------------------------*/
@@ -2225,8 +2301,16 @@ FRESULT f_read (
 		if ((fp->fptr % SS(fp->fs)) == 0) {			/* On the sector boundary? */
 			csect = (BYTE)(fp->fptr / SS(fp->fs) & (fp->fs->csize - 1));	/* Sector offset in the cluster */
 			if (!csect) {							/* On the cluster boundary? */
-				clst = (fp->fptr == 0) ?			/* On the top of the file? */
-					fp->org_clust : get_fat(fp->fs, fp->curr_clust);
+				if (fp->fptr == 0) {				/* On the top of the file? */
+					clst = fp->org_clust;
+				} else {
+#if _USE_FASTSEEK
+					if (fp->cltbl)					/* Get cluster# from the CLMT, no FAT access */
+						clst = clmt_clust(fp, fp->fptr);
+					else
+#endif
+					clst = get_fat(fp->fs, fp->curr_clust);
+				}
 				if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
 				if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
 				fp->curr_clust = clst;				/* Update current cluster */
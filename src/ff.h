@@ -392,6 +392,9 @@ typedef struct {
 	WORD	ftime;			/* Last modified time */
 	BYTE	fattrib;		/* Attribute */
 	TCHAR	fname[13];		/* Short file name (8.3 format) */
+#if _USE_FASTSEEK
+	DWORD	fclust;			/* File start cluster */
+#endif
 #if _USE_LFN
 	TCHAR*	lfname;			/* Pointer to the LFN buffer */
 	UINT 	lfsize;			/* Size of LFN buffer in TCHAR */
@@ -431,6 +434,9 @@ typedef enum {
 
 FRESULT f_mount (BYTE, FATFS*);						/* Mount/Unmount a logical drive */
 FRESULT f_open (FIL*, const TCHAR*, BYTE);			/* Open or create a file */
+#if _USE_FASTSEEK
+FRESULT f_reopen (FIL*, DWORD, DWORD, WORD);			/* Reopen a file from its start cluster */
+#endif
 FRESULT f_read (FIL*, BYTE*, UINT, UINT*);			/* Read data from a file */
 FRESULT f_lseek (FIL*, DWORD);						/* Move file pointer of a file object */
 FRESULT f_close (FIL*);								/* Close an open file object */
@@ -18,6 +18,9 @@
 
 
 #include <stdint.h>
+#ifdef PCBSKY
+#include "AT91SAM3S4.h"
+#endif
 #include "ersky9x.h"
 #include "stdio.h"
 #include "inttypes.h"
@@ -111,6 +114,20 @@ uint8_t *Eeprom32_buffer_address ;
 uint8_t *Eeprom32_source_address ;
 uint32_t Eeprom32_address ;
 uint32_t Eeprom32_data_size ;
+uint32_t Eeprom32_delta_count ;
+
+// Counters for the memory stat page
+uint16_t Ee32EraseCount ;
+uint16_t Ee32DeltaCount ;
+uint32_t Ee32BytesWritten ;
+uint8_t Ee32DeltasWritten = 1 ;	// Delta records may be in the EEPROM, not known at power on
+
+// A model image read in the background, ready for a quick model switch
+SKYModelData PrefetchModelData ;
+uint8_t PrefetchIndex ;			// File_system entry held, 0 = none
+uint8_t PrefetchRequest ;		// File_system entry wanted
+uint16_t ModelSwitchTime ;	// Last ee32LoadModel(), 2MHz ticks
+uint16_t ModelSwitchHits ;	// Loads that used the prefetched image
 
 
 #define EE_WAIT			0
@@ -130,6 +147,28 @@ uint32_t Eeprom32_data_size ;
 
 //#define E32_READING						10		// Set elsewhere as a lock
 
+#define E32_DELTAREAD					11
+#define E32_DELTASCAN					12
+#define E32_DELTASENDING			13
+#define E32_DELTAWAITING			14
+#define E32_PREFETCHREAD			15
+#define E32_PREFETCHSCAN			16
+
+// Small changes are appended to the erased space after the stored image
+// as delta records, { offset(2), length, checksum, data[length] }. The
+// log ends at a header of all 0xFF. When the records no longer fit, or
+// one is found to be bad, the whole image is written to the other block.
+#define DELTA_HEADER_SIZE			4
+#define DELTA_MAX_RECORD			252		// So a record fits in DeltaBuffer
+#define DELTA_GAP							4			// Merge changes closer than a header
+#define DELTA_BUFFER_SIZE			256
+
+#define DELTA_MORE						0
+#define DELTA_END							1
+#define DELTA_BAD							2
+
+uint8_t DeltaBuffer[DELTA_BUFFER_SIZE] ;
+
 
 void handle_serial( void ) ;
 
@@ -141,6 +180,7 @@ void ee32_read_model_names( void ) ;
 void ee32LoadModelName(uint8_t id, unsigned char*buf,uint8_t len) ;
 void ee32_update_name( uint32_t id, uint8_t *source ) ;
 void convertModel( SKYModelData *dest, ModelData *source ) ;
+uint32_t ee32_apply_deltas( uint32_t block_no, uint32_t base_size, uint8_t *dest, uint32_t dest_size ) ;
 
 
 
@@ -237,6 +277,12 @@ void ee32StoreModel( uint8_t modelNumber, uint8_t trim )
 	ee32_update_name( Model_dirty, (uint8_t *)&g_model ) ;		// In case it's changed
 }
 
+// Ask for a model to be read in the background, id is 0 to MAX_MODELS-1
+void ee32PrefetchModel( uint8_t id )
+{
+	PrefetchRequest = id + 1 ;
+}
+
 void ee32_delete_model( uint8_t id )
 {
 	uint8_t buffer[sizeof(g_model.name)+1] ;
@@ -290,6 +336,7 @@ bool ee32CopyModel(uint8_t dst, uint8_t src)
 	}
 
   read32_eeprom_data( (File_system[src].block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&Eeprom_buffer.data.sky_model_data, size, 0 ) ;
+	ee32_apply_deltas( File_system[src].block_no, size, ( uint8_t *)&Eeprom_buffer.data.sky_model_data, size ) ;
 
   if (size > sizeof(g_model.name))
     memcpy( ModelNames[dst], Eeprom_buffer.data.sky_model_data.name, sizeof(g_model.name)) ;
@@ -318,6 +365,7 @@ void ee32SwapModels(uint8_t id1, uint8_t id2)
   if (id2_size > sizeof(g_model.name))
 	{
     read32_eeprom_data( (id2_block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&Eeprom_buffer.data.sky_model_data, id2_size, 0 ) ;
+		ee32_apply_deltas( id2_block_no, id2_size, ( uint8_t *)&Eeprom_buffer.data.sky_model_data, id2_size ) ;
     memcpy( ModelNames[id1], Eeprom_buffer.data.sky_model_data.name, sizeof(g_model.name)) ;
   }
   else
@@ -498,6 +546,190 @@ uint32_t get_current_block_number( uint32_t block_no, uint16_t *p_size, uint32_t
 	return block_no ;
 }
 
+// Work through the delta records held in DeltaBuffer, applying those
+// that fall inside dest_size to dest. Returns the number of bytes used,
+// *p_status says whether the end of the log was reached
+uint32_t ee32_parse_deltas( uint32_t count, uint32_t base_size, uint8_t *dest, uint32_t dest_size, uint32_t *p_status )
+{
+	uint8_t *p ;
+	uint32_t position ;
+	uint32_t offset ;
+	uint32_t length ;
+	uint32_t i ;
+
+	position = 0 ;
+	*p_status = DELTA_MORE ;
+	while ( position + DELTA_HEADER_SIZE <= count )
+	{
+		p = &DeltaBuffer[position] ;
+		offset = p[0] | ( p[1] << 8 ) ;
+		length = p[2] ;
+		if ( ( offset == 0xFFFF ) && ( length == 0xFF ) && ( p[3] == 0xFF ) )
+		{
+			*p_status = DELTA_END ;
+			break ;
+		}
+		if ( ( length == 0 ) || ( length > DELTA_MAX_RECORD ) || ( offset + length > base_size ) )
+		{
+			*p_status = DELTA_BAD ;
+			break ;
+		}
+		if ( position + DELTA_HEADER_SIZE + length > count )
+		{
+			break ;		// Rest of record not read yet
+		}
+		if ( (uint8_t)( byte_checksum( p, 3 ) + byte_checksum( p + DELTA_HEADER_SIZE, length ) ) != p[3] )
+		{
+			*p_status = DELTA_BAD ;
+			break ;
+		}
+		p += DELTA_HEADER_SIZE ;
+		for ( i = 0 ; i < length ; i += 1 )
+		{
+			if ( offset + i < dest_size )
+			{
+				dest[offset + i] = p[i] ;
+			}
+		}
+		position += DELTA_HEADER_SIZE + length ;
+	}
+	return position ;
+}
+
+// Apply any delta records stored after the image in block block_no.
+// Returns the address for the next record, or 0 if no more may be added.
+// EEPROM must be idle, DeltaBuffer is used
+uint32_t ee32_apply_deltas( uint32_t block_no, uint32_t base_size, uint8_t *dest, uint32_t dest_size )
+{
+	uint32_t address ;
+	uint32_t end ;
+	uint32_t count ;
+	uint32_t used ;
+	uint32_t status ;
+
+	address = ( block_no << 12 ) + sizeof( struct t_eeprom_header ) + base_size ;
+	end = ( block_no + 1 ) << 12 ;
+	for(;;)
+	{
+		if ( address + DELTA_HEADER_SIZE > end )
+		{
+			return 0 ;
+		}
+		count = end - address ;
+		if ( count > DELTA_BUFFER_SIZE )
+		{
+			count = DELTA_BUFFER_SIZE ;
+		}
+		read32_eeprom_data( address, DeltaBuffer, count, EE_WAIT ) ;
+		used = ee32_parse_deltas( count, base_size, dest, dest_size, &status ) ;
+		address += used ;
+		if ( status == DELTA_END )
+		{
+			return address ;
+		}
+		if ( ( status == DELTA_BAD ) || ( used == 0 ) )
+		{
+			return 0 ;
+		}
+	}
+}
+
+// Build the delta records needed to turn the image in Eeprom_buffer
+// into the source data. Returns the number of bytes in DeltaBuffer,
+// more than DELTA_BUFFER_SIZE if they will not fit
+uint32_t ee32_build_deltas()
+{
+	uint8_t *p ;
+	uint8_t *q ;
+	uint8_t *r ;
+	uint32_t size ;
+	uint32_t total ;
+	uint32_t start ;
+	uint32_t last ;
+	uint32_t length ;
+	uint32_t i ;
+
+	p = Eeprom32_source_address ;
+	q = (uint8_t *)&Eeprom_buffer.data ;
+	size = Eeprom32_data_size ;
+	total = 0 ;
+	i = 0 ;
+	while ( i < size )
+	{
+		if ( p[i] == q[i] )
+		{
+			i += 1 ;
+			continue ;
+		}
+		start = last = i ;
+		while ( ( ++i < size ) && ( i - start < DELTA_MAX_RECORD ) )
+		{
+			if ( p[i] != q[i] )
+			{
+				last = i ;
+			}
+			else if ( i - last > DELTA_GAP )
+			{
+				break ;
+			}
+		}
+		length = last - start + 1 ;
+		if ( total + DELTA_HEADER_SIZE + length > DELTA_BUFFER_SIZE )
+		{
+			return DELTA_BUFFER_SIZE + 1 ;
+		}
+		r = &DeltaBuffer[total] ;
+		r[0] = start ;
+		r[1] = start >> 8 ;
+		r[2] = length ;
+		memcpy( r + DELTA_HEADER_SIZE, p + start, length ) ;
+		r[3] = byte_checksum( r, 3 ) + byte_checksum( r + DELTA_HEADER_SIZE, length ) ;
+		total += DELTA_HEADER_SIZE + length ;
+		i = last + 1 ;
+	}
+	return total ;
+}
+
+// Read the next part of the delta log, returns 0 if there is no room left
+static uint32_t ee32_read_delta_chunk()
+{
+	uint32_t end ;
+	uint32_t count ;
+
+	end = ( File_system[Eeprom32_file_index].block_no + 1 ) << 12 ;
+	if ( Eeprom32_address + DELTA_HEADER_SIZE > end )
+	{
+		return 0 ;
+	}
+	count = end - Eeprom32_address ;
+	if ( count > DELTA_BUFFER_SIZE )
+	{
+		count = DELTA_BUFFER_SIZE ;
+	}
+	Eeprom32_delta_count = count ;
+	read32_eeprom_data( Eeprom32_address, DeltaBuffer, count, EE_NO_WAIT ) ;
+	return 1 ;
+}
+
+// Program the next part of DeltaBuffer, without crossing a 256 byte page
+static void ee32_write_delta_chunk()
+{
+	uint32_t x ;
+
+	x = 256 - ( Eeprom32_address & 0xFF ) ;
+	if ( x > Eeprom32_delta_count )
+	{
+		x = Eeprom32_delta_count ;
+	}
+	write32_eeprom_block( Eeprom32_address, Eeprom32_buffer_address, x, EE_NO_WAIT ) ;
+	Ee32DeltasWritten = 1 ;
+	Eeprom32_address += x ;
+	Eeprom32_buffer_address += x ;
+	Eeprom32_delta_count -= x ;
+	Ee32BytesWritten += x ;
+	Eeprom32_process_state = E32_DELTASENDING ;
+}
+
 bool ee32LoadGeneral()
 {
 	uint16_t size ;
@@ -514,6 +746,7 @@ bool ee32LoadGeneral()
 	if ( size )
 	{
 		read32_eeprom_data( ( File_system[0].block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&g_eeGeneral, size, 0 ) ;
+		ee32_apply_deltas( File_system[0].block_no, File_system[0].size, ( uint8_t *)&g_eeGeneral, size ) ;
 	}
 	else
 	{
@@ -562,13 +795,20 @@ void ee32WaitLoadModel(uint8_t id)
 }
 
 extern void closeLogs( void ) ;
+extern void invalidateMixPlan( void ) ;
+extern void buildExpoTables( void ) ;
 
 void ee32LoadModel(uint8_t id)
 {
 	uint16_t size ;
 	uint8_t version = 255 ;
+	uint16_t t0 ;
+	uint16_t t10 ;
 
   closeLogs() ;
+	t0 = getTmr2MHz() ;		// The load itself, not waiting for the log task
+	t10 = get_tmr10ms() ;
+	invalidateMixPlan() ;
 
     if(id<MAX_MODELS)
     {
@@ -604,9 +844,15 @@ void ee32LoadModel(uint8_t id)
 					read32_eeprom_data( ( File_system[id+1].block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&g_oldmodel, size, 0 ) ;
 					convertModel( &g_model, &g_oldmodel ) ;
 				}
+				else if ( PrefetchIndex == id+1 )
+				{
+					memcpy( &g_model, &PrefetchModelData, size ) ;		// Already read in the background
+					ModelSwitchHits += 1 ;
+				}
 				else
 				{
 					read32_eeprom_data( ( File_system[id+1].block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&g_model, size, 0 ) ;
+					ee32_apply_deltas( File_system[id+1].block_no, File_system[id+1].size, ( uint8_t *)&g_model, size ) ;
 				}	 
 				
 				if ( version != 255 )
@@ -740,6 +986,16 @@ void ee32LoadModel(uint8_t id)
 			g_model.telemetryProtocol = TELEMETRY_DSM ;
 		}
 	}
+	buildExpoTables() ;
+	PrefetchIndex = 0 ;		// g_model now has any later changes
+	PrefetchRequest = 0 ;
+
+	t0 = getTmr2MHz() - t0 ;
+	if ( (uint16_t)( get_tmr10ms() - t10 ) > 3 )
+	{
+		t0 = 0xFFFF ;		// Over 30mS, timer may have wrapped
+	}
+	ModelSwitchTime = t0 ;
 }
 
 bool eeModelExists(uint8_t id)
@@ -777,6 +1033,43 @@ void init_eeprom()
 }
 
 
+// Rewrite every file holding delta records as a plain image, so anything
+// reading the raw blocks (the USB EEPROM disk, the bootloader, PC tools or
+// older firmware) sees every change
+void ee32_compact_all()
+{
+	uint32_t i ;
+	uint32_t size ;
+	uint32_t block_no ;
+	uint8_t marker[DELTA_HEADER_SIZE] ;
+
+	ee32WaitFinished() ;
+	for ( i = 0 ; i <= MAX_MODELS ; i += 1 )
+	{
+		size = File_system[i].size ;
+		block_no = File_system[i].block_no ;
+		if ( ( size == 0 ) || ( size > sizeof(Eeprom_buffer.data) )
+				 || ( sizeof( struct t_eeprom_header ) + size + DELTA_HEADER_SIZE > 4096 ) )
+		{
+			continue ;
+		}
+		read32_eeprom_data( ( block_no << 12 ) + sizeof( struct t_eeprom_header ) + size, marker, DELTA_HEADER_SIZE, EE_WAIT ) ;
+		if ( ( marker[0] & marker[1] & marker[2] & marker[3] ) == 0xFF )
+		{
+			continue ;		// Erased, no delta records
+		}
+		wdt_reset() ;
+		read32_eeprom_data( ( block_no << 12 ) + sizeof( struct t_eeprom_header ), ( uint8_t *)&Eeprom_buffer.data, size, EE_WAIT ) ;
+		ee32_apply_deltas( block_no, size, ( uint8_t *)&Eeprom_buffer.data, size ) ;
+		Eeprom32_source_address = (uint8_t *)&Eeprom_buffer.data ;	// Get data from here
+		Eeprom32_data_size = size ;																	// This much
+		Eeprom32_file_index = i ;																		// This file system entry
+		Eeprom32_process_state = E32_BLANKCHECK ;
+		ee32WaitFinished() ;
+	}
+	Ee32DeltasWritten = 0 ;
+}
+
 // For virtual USB diskio
 uint32_t ee32_read_512( uint32_t sector, uint8_t *buffer )
 {
@@ -793,6 +1086,10 @@ uint32_t ee32_read_512( uint32_t sector, uint8_t *buffer )
 	{
 		// null body
 	}
+	if ( Ee32DeltasWritten )
+	{
+		ee32_compact_all() ;		// Before the raw blocks are exposed
+	}
 	read32_eeprom_data( sector * 512, buffer, 512, 0 ) ;
 	return 1 ;		// OK
 }
@@ -822,6 +1119,25 @@ uint32_t ee32_check_finished()
 }
 
 
+// Start a general or model write, as delta records if the image
+// already stored is the same size, otherwise as a full block write
+static void ee32_start_delta()
+{
+	if ( Eeprom32_file_index == PrefetchIndex )
+	{
+		PrefetchIndex = 0 ;
+	}
+	if ( Eeprom32_data_size && ( File_system[Eeprom32_file_index].size == Eeprom32_data_size ) )
+	{
+		read32_eeprom_data( File_system[Eeprom32_file_index].block_no << 12, (uint8_t *)&Eeprom_buffer, Eeprom32_data_size + sizeof( struct t_eeprom_header ), EE_NO_WAIT ) ;
+		Eeprom32_process_state = E32_DELTAREAD ;
+	}
+	else
+	{
+		Eeprom32_process_state = E32_BLANKCHECK ;
+	}
+}
+
 void ee32_process()
 {
 	register uint8_t *p ;
@@ -861,7 +1177,7 @@ void ee32_process()
 			Eeprom32_source_address = (uint8_t *)&g_eeGeneral ;		// Get data fromm here
 			Eeprom32_data_size = sizeof(g_eeGeneral) ;						// This much
 			Eeprom32_file_index = 0 ;								// This file system entry
-			Eeprom32_process_state = E32_BLANKCHECK ;
+			ee32_start_delta() ;
 //			Writing_model = 0 ;
 		}
 		else if ( Ee32_model_write_pending )
@@ -873,7 +1189,7 @@ void ee32_process()
 			Eeprom32_source_address = (uint8_t *)&g_model ;		// Get data from here
 			Eeprom32_data_size = sizeof(g_model) ;						// This much
 			Eeprom32_file_index = Model_dirty ;								// This file system entry
-			Eeprom32_process_state = E32_BLANKCHECK ;
+			ee32_start_delta() ;
 //			Writing_model = Model_dirty ;
 		}
 		else if ( Ee32_model_delete_pending )
@@ -884,10 +1200,147 @@ void ee32_process()
 			Ee32_model_delete_pending = 0 ;
 			Eeprom32_process_state = E32_BLANKCHECK ;
 		}
+		else if ( PrefetchRequest != PrefetchIndex )
+		{
+			// Nothing to write, read the model the user may select next
+			x = PrefetchRequest ;
+			PrefetchIndex = 0 ;
+			PrefetchRequest = 0 ;
+			if ( x && ( x != (uint32_t)g_eeGeneral.currModel + 1 ) && ( x <= MAX_MODELS ) && ( File_system[x].size >= 720 ) )
+			{
+				PrefetchRequest = x ;
+				Eeprom32_file_index = x ;
+				Eeprom32_data_size = File_system[x].size ;
+				x = Eeprom32_data_size ;
+				if ( x > sizeof(g_model) )
+				{
+					x = sizeof(g_model) ;
+				}
+				memset( &PrefetchModelData, 0, sizeof(PrefetchModelData) ) ;
+				read32_eeprom_data( ( File_system[Eeprom32_file_index].block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&PrefetchModelData, x, EE_NO_WAIT ) ;
+				Eeprom32_process_state = E32_PREFETCHREAD ;
+			}
+		}
+	}
+
+	if ( Eeprom32_process_state == E32_PREFETCHREAD )
+	{
+		if ( Spi_complete )
+		{
+			Eeprom32_address = ( File_system[Eeprom32_file_index].block_no << 12 ) + sizeof( struct t_eeprom_header ) + Eeprom32_data_size ;
+			Eeprom32_process_state = E32_PREFETCHSCAN ;
+			if ( ee32_read_delta_chunk() == 0 )
+			{
+				PrefetchIndex = Eeprom32_file_index ;		// No delta records
+				Eeprom32_process_state = E32_IDLE ;
+			}
+		}
+	}
+
+	if ( Eeprom32_process_state == E32_PREFETCHSCAN )
+	{
+		if ( Spi_complete )
+		{
+			uint32_t status ;
+			x = ee32_parse_deltas( Eeprom32_delta_count, Eeprom32_data_size, (uint8_t *)&PrefetchModelData, sizeof(g_model), &status ) ;
+			Eeprom32_address += x ;
+			if ( ( status != DELTA_MORE ) || ( x == 0 ) || ( ee32_read_delta_chunk() == 0 ) )
+			{
+				// Same records applied as ee32LoadModel() would use
+				PrefetchIndex = Eeprom32_file_index ;
+				Eeprom32_process_state = E32_IDLE ;
+			}
+		}
+	}
+
+	if ( Eeprom32_process_state == E32_DELTAREAD )
+	{
+		if ( Spi_complete )
+		{
+			Eeprom32_process_state = E32_BLANKCHECK ;
+			if ( ee32_check_header( &Eeprom_buffer.header )
+					&& ( Eeprom_buffer.header.sequence_no == File_system[Eeprom32_file_index].sequence_no )
+					&& ( Eeprom_buffer.header.data_size == Eeprom32_data_size ) )
+			{
+				Eeprom32_address = ( File_system[Eeprom32_file_index].block_no << 12 ) + sizeof( struct t_eeprom_header ) + Eeprom32_data_size ;
+				if ( ee32_read_delta_chunk() )
+				{
+					Eeprom32_process_state = E32_DELTASCAN ;
+				}
+			}
+		}
+	}
+
+	if ( Eeprom32_process_state == E32_DELTASCAN )
+	{
+		if ( Spi_complete )
+		{
+			uint32_t status ;
+			x = ee32_parse_deltas( Eeprom32_delta_count, Eeprom32_data_size, (uint8_t *)&Eeprom_buffer.data, Eeprom32_data_size, &status ) ;
+			Eeprom32_address += x ;
+			Eeprom32_process_state = E32_BLANKCHECK ;
+			if ( status == DELTA_END )
+			{
+				// Image as stored is now in Eeprom_buffer
+				p = Eeprom32_source_address ;
+				q = (uint8_t *)&Eeprom_buffer.data ;
+				if ( ( Eeprom32_file_index == 0 ) || ( memcmp( p, q, sizeof(g_model.name) ) == 0 ) )
+				{
+					x = ee32_build_deltas() ;
+					if ( x == 0 )
+					{
+						Eeprom32_process_state = E32_IDLE ;		// Nothing changed
+					}
+					else if ( ( x <= DELTA_BUFFER_SIZE )
+								 && ( Eeprom32_address + x <= ( ( File_system[Eeprom32_file_index].block_no + 1 ) << 12 ) ) )
+					{
+						Eeprom32_buffer_address = DeltaBuffer ;
+						Eeprom32_delta_count = x ;
+						ee32_write_delta_chunk() ;
+					}
+				}
+			}
+			else if ( ( status == DELTA_MORE ) && x )
+			{
+				if ( ee32_read_delta_chunk() )
+				{
+					Eeprom32_process_state = E32_DELTASCAN ;
+				}
+			}
+		}
+	}
+
+	if ( Eeprom32_process_state == E32_DELTASENDING )
+	{
+		if ( Spi_complete )
+		{
+			Eeprom32_process_state = E32_DELTAWAITING ;
+		}
+	}
+
+	if ( Eeprom32_process_state == E32_DELTAWAITING )
+	{
+		x = eeprom_read_status() ;
+		if ( ( x & 1 ) == 0 )
+		{
+			if ( Eeprom32_delta_count )
+			{
+				ee32_write_delta_chunk() ;
+			}
+			else
+			{
+				Ee32DeltaCount += 1 ;
+				Eeprom32_process_state = E32_IDLE ;
+			}
+		}
 	}
 
 	if ( Eeprom32_process_state == E32_BLANKCHECK )
 	{
+		if ( Eeprom32_file_index == PrefetchIndex )
+		{
+			PrefetchIndex = 0 ;
+		}
 		eeAddress = File_system[Eeprom32_file_index].block_no ^ 1 ;
 		eeAddress <<= 12 ;		// Block start address
 		Eeprom32_address = eeAddress ;						// Where to put new data
@@ -929,6 +1382,7 @@ void ee32_process()
 				*(p+2) = eeAddress >> 8 ;
 				*(p+3) = eeAddress ;		// 3 bytes address
 				spi_PDC_action( p, 0, 0, 4, 0 ) ;
+				Ee32EraseCount += 1 ;
 				Eeprom32_process_state = E32_ERASESENDING ;
 				Eeprom32_state_after_erase = E32_WRITESTART ;
 //			}
@@ -952,6 +1406,7 @@ void ee32_process()
 		Eeprom_buffer.header.flags = 0 ;
 		Eeprom_buffer.header.hcsum = byte_checksum( (uint8_t *)&Eeprom_buffer, 7 ) ;
 		total_size = Eeprom32_data_size + sizeof( struct t_eeprom_header ) ;
+		Ee32BytesWritten += total_size ;
 		eeAddress = Eeprom32_address ;		// Block start address
 		x = total_size / 256 ;	// # sub blocks
 		x <<= 8 ;						// to offset address
@@ -1487,6 +1942,7 @@ const char *ee32BackupModel( uint8_t modelIndex )
 
 	memset(( uint8_t *)&Eeprom_buffer.data.sky_model_data, 0, sizeof(g_model));
   read32_eeprom_data( (File_system[modelIndex].block_no << 12) + sizeof( struct t_eeprom_header), ( uint8_t *)&Eeprom_buffer.data.sky_model_data, size, 0 ) ;
+	ee32_apply_deltas( File_system[modelIndex].block_no, size, ( uint8_t *)&Eeprom_buffer.data.sky_model_data, size ) ;
 
 	// Build filename
 	setModelFilename( filename, modelIndex ) ;
@@ -34,9 +34,14 @@ extern void ee32_process( void ) ;
 extern bool ee32CopyModel( uint8_t dst, uint8_t src ) ;
 extern void ee32SwapModels( uint8_t id1, uint8_t id2 ) ;
 extern uint32_t ee32_read_512( uint32_t sector, uint8_t *buffer ) ;
+extern void ee32_compact_all( void ) ;
 extern const char *ee32BackupModel( uint8_t modelIndex ) ;
 extern const char *ee32RestoreModel( uint8_t modelIndex, char *filename ) ;
 extern void eeModelChanged( void ) ;
+extern void ee32PrefetchModel( uint8_t id ) ;
+
+extern uint16_t ModelSwitchTime ;
+extern uint16_t ModelSwitchHits ;
 
 struct t_file_entry
 {
@@ -36,6 +36,7 @@
 #include "maintenance.h"
 #include "sound.h"
 #include "mavlink.h"
+#include "logs.h"
 
 // Enumerate FrSky packet codes
 #define LINKPKT         0xfe
@@ -1151,15 +1152,11 @@ extern struct t_fifo64 HexStreamFifo ;
 static bool checkSportPacket()
 {
 	uint8_t *packet = frskyRxBuffer ;
-  uint16_t crc = 0 ;
-  for ( uint8_t i=1; i<FRSKY_SPORT_PACKET_SIZE; i++)
-	{
-    crc += packet[i]; //0-1FF
-    crc += crc >> 8; //0-100
-    crc &= 0x00ff;
-    crc += crc >> 8; //0-0FF
-    crc &= 0x00ff;
-  }
+	// End around carry sum, the 7 bytes fit in 16 bits so fold the carries once at the end
+  uint32_t crc ;
+	crc = packet[1] + packet[2] + packet[3] + packet[4] + packet[5] + packet[6] + packet[7] ;
+	crc = ( crc & 0x00FF ) + ( crc >> 8 ) ;
+	crc = ( crc & 0x00FF ) + ( crc >> 8 ) ;
   return (crc == 0x00ff) ;
 }
 
@@ -1417,6 +1414,7 @@ void processSportPacket()
 void frsky_receive_byte( uint8_t data )
 {
 	TelemetryDebug += 1 ;
+	recordTelemetryByte( data ) ;
 #ifdef PCBSKY
 	if ( g_model.bt_telemetry )
 	{
@@ -1592,6 +1590,85 @@ void frsky_receive_byte( uint8_t data )
   numPktBytes = numbytes ;
 }
 
+// Receive a block of bytes, e.g. from the PDC ring.
+// S.Port is decoded here directly, with the state held locally,
+// anything else is passed on a byte at a time.
+void frsky_receive_block( uint8_t *data, uint32_t count )
+{
+	if ( ( FrskyTelemetryType != 1 ) || RecordActive
+#ifdef PCBSKY
+			 || g_model.bt_telemetry
+#endif
+#ifdef REVX
+			 || ( TelemetryType == TEL_MAVLINK )
+#endif
+		 )
+	{
+		while ( count )
+		{
+			frsky_receive_byte( *data++ ) ;
+			count -= 1 ;
+		}
+		return ;
+	}
+	
+	TelemetryDebug += count ;
+  uint8_t numbytes = numPktBytes ;
+	uint8_t state = dataState ;
+	uint8_t *pbuffer = frskyRxBuffer ;
+	while ( count )
+	{
+		uint8_t x = *data++ ;
+		count -= 1 ;
+    switch ( state )
+    {
+      case frskyDataIdle:
+        if ( x == START_STOP )
+        {
+          numbytes = 0 ;
+          state = frskyDataStart ;
+        }
+			continue ;
+
+      case frskyDataStart:
+				state = frskyDataInFrame ;
+        if ( x == START_STOP )
+				{
+          numbytes = 0 ;
+					continue ;
+				}
+			break ;
+
+      case frskyDataInFrame:
+        if ( x == BYTESTUFF )
+        { 
+          state = frskyDataXOR ; // XOR next byte
+					continue ;
+        }
+        if ( x == START_STOP ) // start of next frame
+        {
+          numbytes = 0 ;
+					continue ;
+        }
+			break ;
+
+      case frskyDataXOR:
+        state = frskyDataInFrame ;
+				x ^= STUFF_MASK ;
+      break ;
+    }
+		pbuffer[numbytes++] = x ;
+  	if ( numbytes >= FRSKY_SPORT_PACKET_SIZE )
+		{
+			processSportPacket() ;    	
+		  numbytes = 0 ;
+			state = frskyDataIdle ;
+		}
+	}
+	dataState = state ;
+  numPktBytes = numbytes ;
+}
+
 /*
    USART0 (transmit) Data Register Emtpy ISR
    Usef to transmit FrSky data packets, which are buffered in frskyTXBuffer. 
@@ -2206,12 +2283,23 @@ void check_frsky( uint32_t fivems )
 					TelemetryReceiver( rxchar ) ;
 				}
 			}
+			else if ( TelemetryReceiver == frsky_receive_byte )
+			{
+				rxPdcUsartBlock( frsky_receive_block ) ;
+			}
 			else
 			{
 				rxPdcUsart( TelemetryReceiver ) ;		// Send serial data here
 			}
 #else			 
-			rxPdcUsart( TelemetryReceiver ) ;		// Send serial data here
+			if ( TelemetryReceiver == frsky_receive_byte )
+			{
+				rxPdcUsartBlock( frsky_receive_block ) ;
+			}
+			else
+			{
+				rxPdcUsart( TelemetryReceiver ) ;		// Send serial data here
+			}
 #endif
 		}
 		else
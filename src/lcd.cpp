@@ -912,6 +912,16 @@ extern uint8_t CurrentVolume ;
 uint8_t LcdLock ;
 uint16_t LcdInputs ;
 
+#ifdef PCBSKY
+// Copy of what the LCD controller holds, so a refresh only sends the
+// columns of each page that have changed since the last one
+uint8_t LcdShadow[DISPLAY_W*DISPLAY_H/8] ;
+uint8_t LcdFullRefresh = 1 ;
+uint8_t LcdRefreshCount ;
+uint16_t LcdBytesSent ;		// Data bytes sent by the last refresh
+uint8_t LcdColumnOffset ;		// Column offset the shadow was sent with
+#endif // PCBSKY
+
 
 
 #ifndef PCBDUE
@@ -1004,6 +1014,7 @@ void lcd_init()
 	{
 	  lcdSendCtl( Lcdinit[i] ) ;
 	}
+	LcdFullRefresh = 1 ;		// Controller RAM is now unknown
 //  lcdSendCtl(0xe2); //Initialize the internal functions
 //  lcdSendCtl(0xae); //DON = 0: display OFF
 //	lcdSendCtl(0xa1); //ADC = 1: reverse direction(SEG132->SEG1)
@@ -1138,10 +1149,54 @@ void lcdSendCtl(uint8_t val)
 //#endif	
 }
 
+// Returns the number of bytes of page y to send, starting at column *start,
+// and updates the shadow. One page is resent in full every 16 refreshes in
+// case the controller RAM has been disturbed.
+static uint32_t lcdDirtySpan( uint32_t y, uint32_t *start )
+{
+	register uint8_t *p = &DisplayBuf[y*DISPLAY_W] ;
+	register uint8_t *q = &LcdShadow[y*DISPLAY_W] ;
+	register uint32_t first ;
+	register uint32_t last ;
+
+	first = 0 ;
+	last = DISPLAY_W ;
+	if ( !LcdFullRefresh && ( ( LcdRefreshCount & 0x7F ) != ( y << 4 ) ) )
+	{
+		while ( p[first] == q[first] )
+		{
+			first += 1 ;
+			if ( first >= DISPLAY_W )
+			{
+				return 0 ;
+			}
+		}
+		while ( p[last-1] == q[last-1] )
+		{
+			last -= 1 ;
+		}
+	}
+	memcpy( &q[first], &p[first], last - first ) ;
+	*start = first ;
+	return last - first ;
+}
+
 #ifdef SIMU
 void refreshDisplay()
 {
-  memcpy(lcd_buf, DisplayBuf, sizeof(DisplayBuf));
+	uint32_t y ;
+	uint32_t first ;
+	uint32_t count ;
+
+	LcdBytesSent = 0 ;
+  for( y=0; y < 8; y++)
+	{
+		count = lcdDirtySpan( y, &first ) ;
+		memcpy( &lcd_buf[y*DISPLAY_W+first], &DisplayBuf[y*DISPLAY_W+first], count ) ;
+		LcdBytesSent += count ;
+	}
+	LcdFullRefresh = 0 ;
+	LcdRefreshCount += 1 ;
   lcd_refresh = true;
 }
 #else
@@ -1153,6 +1208,9 @@ void refreshDisplay()
 	register uint32_t x ;
 	register uint32_t z ;
 	register uint32_t ebit ;
+	uint32_t first ;
+	uint32_t column ;
+	uint32_t offset ;
 
 //extern uint32_t ProtocolCount ;
 //lcd_outhex4 (0, 0, ProtocolCount ) ;
@@ -1180,9 +1238,24 @@ void refreshDisplay()
 #else
 	pioptr->PIO_OER = 0x0C00B0FFL ;		// Set bits 27,26,15,13,12,7-0 output
 #endif // REVB
+	offset = g_eeGeneral.optrexDisplay ? 0 : 0x04 ;
+	if ( offset != LcdColumnOffset )
+	{
+		LcdColumnOffset = offset ;
+		LcdFullRefresh = 1 ;		// Display type changed, the shadow is at the wrong columns
+	}
+	LcdBytesSent = 0 ;
   for( y=0; y < 8; y++) {
-    lcdSendCtl( g_eeGeneral.optrexDisplay ? 0 : 0x04 ) ;
-    lcdSendCtl(0x10); //column addr 0
+		z = lcdDirtySpan( y, &first ) ;
+		if ( z == 0 )
+		{
+			continue ;
+		}
+		LcdBytesSent += z ;
+		p = &DisplayBuf[y*DISPLAY_W+first] ;
+		column = first + offset ;
+    lcdSendCtl( column & 0x0F ) ;				// column addr low
+    lcdSendCtl( 0x10 | ( column >> 4 ) ) ; //column addr high
     lcdSendCtl( y | 0xB0); //page addr y
     
 #ifndef REVX
@@ -1199,7 +1272,7 @@ void refreshDisplay()
 #else 
 		x =	lookup[*p] ;
 #endif // REVB
-    for( z=0; z<128; z+=1)
+    for( ; z ; z-=1)
 		{
 
 // The following 7 lines replaces by a lookup table	 
@@ -1231,6 +1304,8 @@ void refreshDisplay()
 //		pioptr->PIO_SODR = LCD_CS1 ;		// Deselect LCD
 //#endif 
   }
+	LcdFullRefresh = 0 ;
+	LcdRefreshCount += 1 ;
 	pioptr->PIO_ODSR = 0xFF ;					// Drive lines high
 #ifdef REVB
 	pioptr->PIO_PUER = 0x000000FEL ;	// Set bits 1, 3, 4, 5 with pullups
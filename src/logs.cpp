@@ -42,6 +42,11 @@
 #include "string.h"
 #include <stdlib.h>
 #include "menus.h"
+#include "logs.h"
+
+#ifndef SIMU
+#include "CoOS.h"
+#endif
 
 #define NULL 0
 
@@ -52,6 +57,361 @@ FIL g_oLogFile = {0};
 const char *g_logError = NULL ;
 uint8_t logDelay;
 
+// Input recording
+#define RECORD_BUFFER_SIZE	1024
+
+FIL g_oRecordFile = {0};
+uint8_t RecordBuffer[2][RECORD_BUFFER_SIZE] ;
+volatile uint16_t RecordLength[2] ;		// Non-zero when the half is waiting to be written
+uint16_t RecordIndex ;
+uint8_t RecordHalf ;
+uint8_t RecordTelemetry[RECORD_MAX_TELEMETRY] ;
+uint8_t RecordTelemetryCount ;
+uint8_t RecordKeys ;
+uint8_t RecordTrims ;
+uint8_t RecordActive ;
+uint16_t RecordOverruns ;
+
+extern uint16_t S_anaFilt[] ;
+
+static void openRecord( const char *filename ) ;
+
+// Binary logging
+static const char *const LogItemNames[LOG_SC1] =
+{
+	"Valid", "RxRSSI", "TxRSSI", "Fades", "Holds", "A1", "A2", "AltB", "AltG",
+	"Temp1", "Temp2", "RPM", "Amps", "Volts", "mAH", "TxBat", "Vspd", "RxV",
+	"Lat", "Latd", "NS", "Long", "Longd", "EW", "Fuel", "Gspd"
+} ;
+
+// 10mS ticks for each g_model.logFields[].rate, 1Hz to 50Hz
+static const uint8_t LogRateIntervals[LOG_NUM_RATES] = { 100, 50, 20, 10, 5, 2 } ;
+
+uint32_t BinLogBuffer[2][BINLOG_SECTOR_SIZE/4] ;		// uint32_t for alignment
+volatile uint8_t BinLogFull[2] ;		// Non-zero when the sector is waiting to be written
+uint16_t BinLogIndex ;
+uint8_t BinLogHalf ;
+uint8_t BinLogFields[BINLOG_MAX_FIELDS] ;
+uint8_t BinLogInterval[BINLOG_MAX_FIELDS] ;
+uint8_t BinLogCount[BINLOG_MAX_FIELDS] ;		// Ticks until the field is next due
+uint8_t BinLogNumFields ;
+uint8_t BinLogActive ;
+uint16_t BinLogOverruns ;
+
+void logItemName( uint8_t item, char *name )
+{
+	const char *s = NULL ;
+	uint8_t n = 0 ;
+
+	if ( item < LOG_SC1 )
+	{
+		s = ( ( item == LOG_TXRSSI ) && ( FrskyTelemetryType == 1 ) ) ? "Swr" : LogItemNames[item] ;
+	}
+	else if ( item < LOG_STICK1 )
+	{
+		s = "SC" ;
+		n = item - LOG_SC1 + 1 ;
+	}
+	else if ( item < LOG_STICK1 + 4 )
+	{
+		s = "Stk" ;
+		n = item - LOG_STICK1 + 1 ;
+	}
+	else if ( item < LOG_CH1 )
+	{
+		s = "P" ;
+		n = item - LOG_STICK1 - 3 ;
+	}
+	else if ( item < LOG_SWITCHES )
+	{
+		s = "CH" ;
+		n = item - LOG_CH1 + 1 ;
+	}
+	else
+	{
+		s = "Sw" ;
+	}
+	strcpy( name, s ) ;
+	if ( n )
+	{
+		name += strlen( name ) ;
+		if ( n > 9 )
+		{
+			*name++ = '0' + n / 10 ;
+		}
+		*name++ = '0' + n % 10 ;
+		*name = '\0' ;
+	}
+}
+
+static int16_t getLogItem( uint8_t item, uint8_t *format )
+{
+	int16_t value ;
+	uint8_t dps ;
+
+	*format = 0 ;
+	switch ( item )
+	{
+		case LOG_VALID :
+		return frskyUsrStreaming * 100 + frskyStreaming ;
+		case LOG_RXRSSI :
+		return FrskyHubData[FR_RXRSI_COPY] ;
+		case LOG_TXRSSI :
+		return FrskyHubData[FR_TXRSI_COPY] ;
+		case LOG_FADES :
+		return DsmABLRFH[4] ;
+		case LOG_HOLDS :
+		return DsmABLRFH[5] ;
+		case LOG_A1 :
+		case LOG_A2 :
+			value = logAxScale( item - LOG_A1, &dps ) ;
+			*format = ( dps == 10 ) ? 1 : 2 ;
+		return value ;
+		case LOG_ALTB :
+			value =  FrskyHubData[FR_ALT_BARO] + AltOffset ;
+			if (g_model.FrSkyUsrProto == 0)  // Hub
+			{
+      	if ( g_model.FrSkyImperial )
+				{
+       		value = m_to_ft( value ) ;
+				}
+			}
+		return value / 10 ;
+		case LOG_ALTG :
+		return FrskyHubData[FR_GPS_ALT] ;
+		case LOG_TEMP1 :
+		return FrskyHubData[FR_TEMP1] ;
+		case LOG_TEMP2 :
+		return FrskyHubData[FR_TEMP2] ;
+		case LOG_RPM :
+		return FrskyHubData[FR_RPM] ;
+		case LOG_AMPS :
+			*format = 1 ;
+		return FrskyHubData[FR_CURRENT] ;
+		case LOG_VOLTS :
+			*format = 1 ;
+		return FrskyHubData[FR_VOLTS] ;
+		case LOG_MAH :
+		return FrskyHubData[FR_AMP_MAH] ;
+		case LOG_TXBAT :
+			*format = 1 ;
+		return g_vbat100mV ;
+		case LOG_VSPD :
+		return FrskyHubData[FR_VSPD] ;
+		case LOG_RXV :
+			*format = 1 ;
+		return convertRxv( FrskyHubData[FR_RXV] ) ;
+		case LOG_LAT :
+		return FrskyHubData[FR_GPS_LAT] ;
+		case LOG_LATD :
+		return FrskyHubData[FR_GPS_LATd] ;
+		case LOG_NS :
+			*format = BINLOG_FMT_CHAR ;
+		return FrskyHubData[FR_LAT_N_S] ;
+		case LOG_LONG :
+		return FrskyHubData[FR_GPS_LONG] ;
+		case LOG_LONGD :
+		return FrskyHubData[FR_GPS_LONGd] ;
+		case LOG_EW :
+			*format = BINLOG_FMT_CHAR ;
+		return FrskyHubData[FR_LONG_E_W] ;
+		case LOG_FUEL :
+		return FrskyHubData[FR_FUEL] ;
+		case LOG_GSPD :
+		return FrskyHubData[FR_GPS_SPEED] ;
+	}
+	if ( item < LOG_STICK1 )
+	{
+		uint8_t unit ;
+		return calc_scaler( item - LOG_SC1, &unit, format ) ;
+	}
+	if ( item < LOG_CH1 )
+	{
+		return calibratedStick[item - LOG_STICK1] ;
+	}
+	if ( item < LOG_SWITCHES )
+	{
+		return g_chans512[item - LOG_CH1] ;
+	}
+	if ( item == LOG_SWITCHES )
+	{
+		return getCurrentSwitchStates() ;
+	}
+	return 0 ;
+}
+
+static void openBinLog()
+{
+	struct t_binLogHeader *h ;
+	char *names ;
+	char *end ;
+	uint32_t i ;
+	uint32_t n ;
+	UINT written ;
+
+	// Selected fields, each at its own rate, else all the telemetry
+	n = 0 ;
+	for ( i = 0 ; i < NUM_LOG_FIELDS ; i += 1 )
+	{
+		LogFieldData *pf = &g_model.logFields[i] ;
+		if ( pf->item && ( pf->item <= LOG_NUM_ITEMS ) )
+		{
+			BinLogFields[n] = pf->item - 1 ;
+			BinLogInterval[n++] = LogRateIntervals[ pf->rate < LOG_NUM_RATES ? pf->rate : 0 ] ;
+		}
+	}
+	if ( n == 0 )
+	{
+		for ( i = 0 ; i < LOG_NUM_TELEMETRY ; i += 1 )
+		{
+			if ( ( ( i == LOG_FADES ) || ( i == LOG_HOLDS ) ) && ( g_model.DsmTelemetry == 0 ) )
+			{
+				continue ;
+			}
+			BinLogFields[n] = i ;
+			BinLogInterval[n++] = BINLOG_INTERVAL ;
+		}
+	}
+	BinLogNumFields = n ;
+	for ( i = 0 ; i < n ; i += 1 )
+	{
+		BinLogCount[i] = 1 ;		// All fields in the first record
+	}
+
+	// Header sector, built in the first buffer before logging starts
+	memset( BinLogBuffer[0], 0, BINLOG_SECTOR_SIZE ) ;
+	h = (struct t_binLogHeader *) BinLogBuffer[0] ;
+	h->magic = BINLOG_MAGIC ;
+	h->version = BINLOG_VERSION ;
+	h->numFields = n ;
+	h->year = Time.year ;
+	h->month = Time.month ;
+	h->date = Time.date ;
+	h->hour = Time.hour ;
+	h->minute = Time.minute ;
+	h->second = Time.second ;
+#ifdef PCBSKY
+	h->board = 0 ;
+#endif
+#ifdef PCBX9D
+	h->board = 1 ;
+#endif
+	memcpy( h->modelName, g_model.name, sizeof(g_model.name) ) ;
+	names = (char *)(h+1) ;
+	end = (char *)BinLogBuffer[0] + BINLOG_SECTOR_SIZE - 1 ;
+	for ( i = 0 ; i < n ; i += 1 )
+	{
+		char s[8] ;
+		getLogItem( BinLogFields[i], &h->format[i] ) ;
+		h->interval[i] = BinLogInterval[i] ;
+		logItemName( BinLogFields[i], s ) ;
+		if ( names + strlen( s ) + 1 >= end )
+		{
+			break ;		// Out of room, converter names the rest
+		}
+		if ( i )
+		{
+			*names++ = ',' ;
+		}
+		strcpy( names, s ) ;
+		names += strlen( s ) ;
+	}
+
+	// Sectors are written whole, keep them aligned in the file
+	f_lseek( &g_oLogFile, ( f_size(&g_oLogFile) + BINLOG_SECTOR_SIZE - 1 ) & ~(BINLOG_SECTOR_SIZE - 1) ) ;
+	f_write( &g_oLogFile, (BYTE *)BinLogBuffer[0], BINLOG_SECTOR_SIZE, &written ) ;
+
+	((struct t_binLogSector *)BinLogBuffer[0])->magic = BINLOG_SECTOR_MAGIC ;
+	((struct t_binLogSector *)BinLogBuffer[0])->count = 0 ;
+	BinLogFull[0] = 0 ;
+	BinLogFull[1] = 0 ;
+	BinLogIndex = sizeof(struct t_binLogSector) ;
+	BinLogHalf = 0 ;
+	BinLogOverruns = 0 ;
+	BinLogActive = 1 ;
+}
+
+// Called every 10mS from perMain() while binary logging
+void binLogSample()
+{
+	struct t_binLogSector *p ;
+	uint16_t mask[BINLOG_MASK_SIZE] ;
+	int16_t *q ;
+	uint32_t i ;
+	uint32_t size ;
+	uint32_t masks ;
+	uint8_t format ;
+	uint8_t half = BinLogHalf ;
+
+	masks = ( BinLogNumFields + 15 ) >> 4 ;
+	size = 0 ;
+	for ( i = 0 ; i < masks ; i += 1 )
+	{
+		mask[i] = 0 ;
+	}
+	for ( i = 0 ; i < BinLogNumFields ; i += 1 )
+	{
+		if ( --BinLogCount[i] == 0 )
+		{
+			BinLogCount[i] = BinLogInterval[i] ;
+			mask[i>>4] |= 1 << (i & 15) ;
+			size += sizeof(int16_t) ;
+		}
+	}
+	if ( size == 0 )
+	{
+		return ;		// Nothing due this tick
+	}
+	size += sizeof(uint16_t) * ( 1 + masks ) ;
+	if ( BinLogIndex + size > BINLOG_SECTOR_SIZE )
+	{
+		if ( BinLogFull[half^1] )
+		{
+			BinLogOverruns += 1 ;		// Log task hasn't written the other sector yet
+			return ;
+		}
+		BinLogFull[half] = 1 ;
+		BinLogHalf = half ^= 1 ;
+		p = (struct t_binLogSector *) BinLogBuffer[half] ;
+		p->magic = BINLOG_SECTOR_MAGIC ;
+		p->count = 0 ;
+		BinLogIndex = sizeof(struct t_binLogSector) ;
+	}
+	p = (struct t_binLogSector *) BinLogBuffer[half] ;
+	q = (int16_t *) ((uint8_t *)p + BinLogIndex) ;
+	*q++ = get_tmr10ms() ;
+	for ( i = 0 ; i < masks ; i += 1 )
+	{
+		*q++ = mask[i] ;
+	}
+	for ( i = 0 ; i < BinLogNumFields ; i += 1 )
+	{
+		if ( mask[i>>4] & ( 1 << (i & 15) ) )
+		{
+			*q++ = getLogItem( BinLogFields[i], &format ) ;
+		}
+	}
+	p->count += 1 ;
+	BinLogIndex += size ;
+}
+
+// Write any full sectors, called from the log task.  BinLogFull[] is only
+// cleared after the write, closeLogs() leaves the file to this task.
+void flushBinLog()
+{
+	UINT written ;
+	uint32_t i ;
+
+	for ( i = 0 ; i < 2 ; i += 1 )
+	{
+		if ( BinLogFull[i] )
+		{
+			f_write( &g_oLogFile, (BYTE *)BinLogBuffer[i], BINLOG_SECTOR_SIZE, &written ) ;
+			BinLogFull[i] = 0 ;
+		}
+	}
+}
+
 //#if defined(PCBTARANIS)
 //  #define get2PosState(sw) (switchState(SW_ ## sw ## 0) ? -1 : 1)
 //#else
@@ -151,7 +511,7 @@ extern uint32_t sdMounted( void ) ;
   filename[len+9] = '0' + qr.quot;
 //#endif
 
-  strcpy_P(&filename[len+11], ".csv" ) ;
+  strcpy_P(&filename[len+11], g_model.logBinary ? ".blg" : ".csv" ) ;
 
   result = f_open(&g_oLogFile, filename, FA_OPEN_ALWAYS | FA_WRITE);
   if (result != FR_OK)
@@ -196,25 +556,200 @@ extern uint32_t sdMounted( void ) ;
       return "SD CARD ERROR" ; // SDCARD_ERROR(result) ;
     }
   }
-  f_puts("Time,Elapsed,Valid,RxRSSI,", &g_oLogFile) ;
-  f_puts( FrskyTelemetryType == 1 ? "Swr" : "TxRSSI", &g_oLogFile ) ;
-  if ( g_model.DsmTelemetry )
+	if ( g_model.logBinary )
 	{
-		f_puts(",Fades,Holds", &g_oLogFile) ;
+		openBinLog() ;
+	}
+	else
+	{
+	  f_puts("Time,Elapsed,Valid,RxRSSI,", &g_oLogFile) ;
+	  f_puts( FrskyTelemetryType == 1 ? "Swr" : "TxRSSI", &g_oLogFile ) ;
+	  if ( g_model.DsmTelemetry )
+		{
+			f_puts(",Fades,Holds", &g_oLogFile) ;
+		}
+	  f_puts(",A1,A2,AltB,AltG,Temp1,Temp2,RPM,Amps,Volts,mAH,TxBat,Vspd,RxV,Lat,Long,Fuel,Gspd,SC1,SC2,SC3,SC4,SC5,SC6,SC7,SC8\n", &g_oLogFile);
+	}
+
+	if ( g_model.logRecord )
+	{
+	  strcpy_P(&filename[len+11], ".rec" ) ;
+		openRecord( filename ) ;
 	}
-  f_puts(",A1,A2,AltB,AltG,Temp1,Temp2,RPM,Amps,Volts,mAH,TxBat,Vspd,RxV,Lat,Long,Fuel,Gspd,SC1,SC2,SC3,SC4,SC5,SC6,SC7,SC8\n", &g_oLogFile);
 
   return NULL ;
 }
 
+static void openRecord( const char *filename )
+{
+	struct t_recordHeader header ;
+	UINT written ;
+
+  if ( f_open(&g_oRecordFile, filename, FA_OPEN_ALWAYS | FA_WRITE) != FR_OK )
+	{
+		return ;
+	}
+  if ( f_lseek(&g_oRecordFile, f_size(&g_oRecordFile)) != FR_OK )		// append
+	{
+		f_close( &g_oRecordFile ) ;
+		return ;
+	}
+	header.magic = RECORD_MAGIC ;
+	header.version = RECORD_VERSION ;
+	header.numAnalog = RECORD_NUM_ANALOG ;
+#ifdef PCBSKY
+	header.board = 0 ;
+#endif
+#ifdef PCBX9D
+	header.board = 1 ;
+#endif
+	header.frameSize = sizeof(struct t_recordFrame) ;
+	memcpy( header.modelName, g_model.name, sizeof(g_model.name) ) ;
+	f_write( &g_oRecordFile, (BYTE *)&header, sizeof(header), &written ) ;
+
+	RecordLength[0] = 0 ;
+	RecordLength[1] = 0 ;
+	RecordIndex = 0 ;
+	RecordHalf = 0 ;
+	RecordTelemetryCount = 0 ;
+	RecordOverruns = 0 ;
+	RecordActive = 1 ;
+}
+
+// Called every 10mS from the main task
+void recordFrame()
+{
+	struct t_recordFrame *p ;
+	uint32_t size ;
+	uint32_t i ;
+	uint8_t half = RecordHalf ;
+
+	size = sizeof(struct t_recordFrame) + RecordTelemetryCount ;
+	if ( RecordIndex + size > RECORD_BUFFER_SIZE )
+	{
+		if ( RecordLength[half^1] )
+		{
+			RecordOverruns += 1 ;		// Log task hasn't written the other half yet
+			RecordTelemetryCount = 0 ;
+			return ;
+		}
+		RecordLength[half] = RecordIndex ;
+		RecordHalf = half ^= 1 ;
+		RecordIndex = 0 ;
+	}
+	p = (struct t_recordFrame *) &RecordBuffer[half][RecordIndex] ;
+	p->tmr10ms = get_tmr10ms() ;
+	for ( i = 0 ; i < RECORD_NUM_ANALOG ; i += 1 )
+	{
+		p->analog[i] = S_anaFilt[i] ;
+	}
+	p->keys = RecordKeys ;
+	p->trims = RecordTrims ;
+	p->switches = getCurrentSwitchStates() ;
+	for ( i = 0 ; i < 16 ; i += 1 )
+	{
+		p->ppmIns[i] = g_ppmIns[i] ;
+	}
+	p->ppmInValid = ppmInValid ;
+	p->numTelemetry = RecordTelemetryCount ;
+	memcpy( p+1, RecordTelemetry, RecordTelemetryCount ) ;
+	RecordTelemetryCount = 0 ;
+	RecordIndex += size ;
+}
+
+void recordTelemetryByte( uint8_t data )
+{
+	if ( RecordActive )
+	{
+		if ( RecordTelemetryCount < RECORD_MAX_TELEMETRY )
+		{
+			RecordTelemetry[RecordTelemetryCount++] = data ;
+		}
+	}
+}
+
+// Called from the log task, writes any full half buffers.  As with
+// flushBinLog(), nothing else writes the file while it is open.
+void flushRecord()
+{
+	UINT written ;
+	uint32_t i ;
+
+	for ( i = 0 ; i < 2 ; i += 1 )
+	{
+		if ( RecordLength[i] )
+		{
+			f_write( &g_oRecordFile, RecordBuffer[i], RecordLength[i], &written ) ;
+			RecordLength[i] = 0 ;
+		}
+	}
+}
+
 // tmr10ms_t lastLogTime = 0;
 
-void closeLogs()
+#ifndef SIMU
+extern OS_TID LogTask ;
+extern uint8_t Activated ;
+#endif
+volatile uint8_t LogCloseRequest ;		// Set by closeLogs() for the log task
+
+static void closeLogFiles()
 {
+	if ( RecordActive )
+	{
+		RecordActive = 0 ;
+		flushRecord() ;
+		if ( RecordIndex )
+		{
+			UINT written ;
+			f_write( &g_oRecordFile, RecordBuffer[RecordHalf], RecordIndex, &written ) ;
+		}
+		f_close( &g_oRecordFile ) ;
+	}
+	if ( BinLogActive )
+	{
+		struct t_binLogSector *p ;
+		BinLogActive = 0 ;
+		flushBinLog() ;
+		p = (struct t_binLogSector *) BinLogBuffer[BinLogHalf] ;
+		if ( p->count )
+		{
+			UINT written ;
+			memset( (uint8_t *)p + BinLogIndex, 0, BINLOG_SECTOR_SIZE - BinLogIndex ) ;
+			f_write( &g_oLogFile, (BYTE *)p, BINLOG_SECTOR_SIZE, &written ) ;
+		}
+	}
   f_close(&g_oLogFile) ;
 //  lastLogTime = 0 ;
 }
 
+// Only the log task writes full buffers to the log files. From any other
+// task, if the log task may be part way through one of those writes, the
+// close is handed to it. Otherwise the files are closed straight away.
+void closeLogs()
+{
+#ifndef SIMU
+	if ( Activated && ( CoGetCurTaskID() != LogTask ) )
+	{
+		if ( RecordLength[0] || RecordLength[1] || BinLogFull[0] || BinLogFull[1] )
+		{
+			uint32_t i ;
+			LogCloseRequest = 1 ;
+			for ( i = 0 ; i < 5 ; i += 1 )
+			{
+				if ( LogCloseRequest == 0 )
+				{
+					return ;
+				}
+				CoTickDelay(1) ;					// 2mS
+			}
+			LogCloseRequest = 0 ;		// No answer in one log task period, close here
+		}
+	}
+#endif
+	closeLogFiles() ;
+}
+
 // TODO test when disk full
 void writeLogs()
 {
@@ -240,6 +775,11 @@ void writeLogs()
         }
       }
 
+			if ( BinLogActive )
+			{
+				return ;		// Records are taken by binLogSample()
+			}
+
 //#if defined(RTCLOCK)
 //      struct gtm utm;
 //      gettime(&utm);
@@ -0,0 +1,172 @@
+/****************************************************************************
+*  Copyright (c) 2015 by Michael Blandford. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+****************************************************************************
+*  History:
+*
+****************************************************************************/
+
+#ifndef logs_h
+#define logs_h
+
+// Input recording, written alongside the .csv log as a .rec file.
+// A file holds one or more sessions, each a t_recordHeader followed by
+// t_recordFrame entries, one per 10mS. Each frame is followed by
+// numTelemetry raw bytes as passed to frsky_receive_byte().
+// All values are little endian.
+
+#define RECORD_MAGIC					0x43455245		// "EREC"
+#define RECORD_VERSION				1
+#define RECORD_NUM_ANALOG			(NUMBER_ANALOG+NUM_EXTRA_ANALOG)
+#define RECORD_MAX_TELEMETRY	64
+
+PACK(struct t_recordHeader
+{
+	uint32_t magic ;
+	uint8_t version ;
+	uint8_t numAnalog ;
+	uint8_t board ;					// 0 SKY, 1 X9D
+	uint8_t frameSize ;			// Size of t_recordFrame
+	char modelName[10] ;
+}) ;
+
+PACK(struct t_recordFrame
+{
+	uint16_t tmr10ms ;
+	uint16_t analog[RECORD_NUM_ANALOG] ;	// S_anaFilt[], as read by anaIn()
+	uint8_t keys ;									// read_keys()
+	uint8_t trims ;									// read_trims()
+	uint16_t switches ;							// getCurrentSwitchStates()
+	int16_t ppmIns[16] ;						// g_ppmIns[]
+	uint8_t ppmInValid ;
+	uint8_t numTelemetry ;
+}) ;
+
+extern uint8_t RecordKeys ;
+extern uint8_t RecordTrims ;
+extern uint8_t RecordActive ;
+extern uint16_t RecordOverruns ;
+
+extern void recordFrame( void ) ;
+extern void recordTelemetryByte( uint8_t data ) ;
+extern void flushRecord( void ) ;
+
+// Binary log, written instead of the .csv log as a .blg file when
+// g_model.logBinary is set. The file is a sequence of 512 byte sectors.
+// Each session starts with a sector holding a t_binLogHeader followed by
+// the comma separated field names, zero terminated. The remaining sectors
+// hold a t_binLogSector followed by count records. A record is a uint16_t
+// tmr10ms, a bit mask of the fields present ((numFields+15)/16 uint16_t)
+// and an int16_t value for each field present, in field order.
+// Field n is present every interval[n] 10mS ticks.
+// format[] gives the number of decimal places of each field, or
+// BINLOG_FMT_CHAR if the value is a character.
+// src/blog2csv.py converts a .blg file to .csv
+// Version 1 files have a single interval and every field in every record,
+// blog2csv.py still reads them.
+
+#define BINLOG_MAGIC					0x474F4C45		// "ELOG"
+#define BINLOG_SECTOR_MAGIC		0x4442				// "BD"
+#define BINLOG_VERSION				2
+#define BINLOG_SECTOR_SIZE		512
+#define BINLOG_MAX_FIELDS			48
+#define BINLOG_FMT_CHAR				0x80
+#define BINLOG_INTERVAL				5							// 10mS ticks, 20Hz, if no fields selected
+#define BINLOG_MASK_SIZE			((BINLOG_MAX_FIELDS+15)/16)
+
+// Loggable items, g_model.logFields[].item is one of these plus 1
+enum LogItems
+{
+	LOG_VALID,
+	LOG_RXRSSI,
+	LOG_TXRSSI,
+	LOG_FADES,
+	LOG_HOLDS,
+	LOG_A1,
+	LOG_A2,
+	LOG_ALTB,
+	LOG_ALTG,
+	LOG_TEMP1,
+	LOG_TEMP2,
+	LOG_RPM,
+	LOG_AMPS,
+	LOG_VOLTS,
+	LOG_MAH,
+	LOG_TXBAT,
+	LOG_VSPD,
+	LOG_RXV,
+	LOG_LAT,
+	LOG_LATD,
+	LOG_NS,
+	LOG_LONG,
+	LOG_LONGD,
+	LOG_EW,
+	LOG_FUEL,
+	LOG_GSPD,
+	LOG_SC1,
+	LOG_STICK1 = LOG_SC1 + NUM_SCALERS,		// calibratedStick[], sticks then pots
+	LOG_CH1 = LOG_STICK1 + 7,							// g_chans512[]
+	LOG_SWITCHES = LOG_CH1 + NUM_SKYCHNOUT,	// getCurrentSwitchStates()
+	LOG_NUM_ITEMS
+} ;
+
+#define LOG_NUM_TELEMETRY		LOG_STICK1		// Logged when no fields are selected
+#define LOG_NUM_RATES				6
+
+PACK(struct t_binLogHeader
+{
+	uint32_t magic ;
+	uint8_t version ;
+	uint8_t numFields ;
+	uint16_t year ;					// Time when logging started
+	uint8_t month ;
+	uint8_t date ;
+	uint8_t hour ;
+	uint8_t minute ;
+	uint8_t second ;
+	uint8_t board ;					// 0 SKY, 1 X9D
+	char modelName[10] ;
+	uint8_t format[BINLOG_MAX_FIELDS] ;
+	uint8_t interval[BINLOG_MAX_FIELDS] ;	// 10mS ticks
+}) ;
+
+PACK(struct t_binLogSector
+{
+	uint16_t magic ;
+	uint16_t count ;
+}) ;
+
+extern uint8_t BinLogActive ;
+extern uint16_t BinLogOverruns ;
+
+extern void binLogSample( void ) ;
+extern void flushBinLog( void ) ;
+extern void logItemName( uint8_t item, char *name ) ;
+
+#endif
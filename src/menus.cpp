@@ -36,6 +36,7 @@
 #include "stringidx.h"
 #include "templates.h"
 #include "pulses.h"
+#include "logs.h"
 #ifdef FRSKY
 #include "frsky.h"
 #endif
@@ -288,6 +289,7 @@ void voice_telem_item( int8_t index )
 //	uint8_t att = 0 ;
 #endif
 
+	voiceReadout( 0x80 + index ) ;		// Replaces an older readout still queued
 	value = get_telemetry_value( index ) ;
 	if (telemItemValid( index ) == 0 )
 	{
@@ -432,6 +434,7 @@ void voice_telem_item( int8_t index )
 	{
 		voice_numeric( value, num_decimals, unit ) ;
 	}
+	voiceReadout( 0 ) ;
 }
 
 
@@ -979,8 +982,10 @@ void menuProcModelIndex(uint8_t event) ;
 void menuProcBattery(uint8_t event) ;
 void menuProcStatistic(uint8_t event) ;
 void menuProcStatistic2(uint8_t event) ;
+void menuProcLatency(uint8_t event) ;
 void menuProcDsmDdiag(uint8_t event) ;
 void menuProcTrainDdiag(uint8_t event) ;
+void menuProcVoiceDdiag(uint8_t event) ;
 
 void menuProcVoiceAlarm(uint8_t event) ;
 
@@ -1079,8 +1084,12 @@ enum EnumTabStat
 	e_battery,
 	e_stat1,
 	e_stat2,
+#ifdef PCBSKY
+	e_latency,
+#endif
 	e_dsm,
 	e_traindiag,
+	e_voicediag,
   e_Setup2,
   e_Setup3,
   e_Boot
@@ -1091,8 +1100,12 @@ MenuFuncP menuTabStat[] =
 	menuProcBattery,
 	menuProcStatistic,
 	menuProcStatistic2,
+#ifdef PCBSKY
+	menuProcLatency,
+#endif
 	menuProcDsmDdiag,
 	menuProcTrainDdiag,
+	menuProcVoiceDdiag,
   menuProcSetup2,
 	menuProcSDstat,
 	menuProcBoot
@@ -2237,16 +2250,18 @@ void menuProcTelemetry(uint8_t event)
 {
 	EditType = EE_MODEL ;
 
+#define TLOGITEMS		(2+NUM_LOG_FIELDS)
+
 #ifdef PCBSKY
  #ifdef REVX
-  #define TDATAITEMS	42
+  #define TDATAITEMS	(42+TLOGITEMS)
  #else
-  #define TDATAITEMS	41
+  #define TDATAITEMS	(41+TLOGITEMS)
  #endif
 #endif
 
 #ifdef PCBX9D
-  #define TDATAITEMS	40
+  #define TDATAITEMS	(40+TLOGITEMS)
 #endif
 
 		 
@@ -2682,7 +2697,7 @@ uint8_t y = 2*FH;
 			subN++;
 		}
 	}
-	else if ( sub <= TDATAITEMS - 7 )
+	else if ( sub <= TDATAITEMS - 7 - TLOGITEMS )
 	{
 #ifdef PCBSKY
 		uint8_t subN = 24+6 ;
@@ -2842,9 +2857,9 @@ uint8_t y = 2*FH;
 //#endif
 		
 	}
-	else
+	else if ( sub <= TDATAITEMS - TLOGITEMS )
 	{
-		uint8_t subN = TDATAITEMS - 6 ;
+		uint8_t subN = TDATAITEMS - 6 - TLOGITEMS ;
 		// Vario
    	for( uint8_t j=0 ; j<7 ; j += 1 )
 		{
@@ -2910,6 +2925,60 @@ uint8_t y = 2*FH;
 			subN += 1 ;
 		}
 	}
+	else if ( sub <= TDATAITEMS - NUM_LOG_FIELDS )
+	{
+		uint8_t subN = TDATAITEMS - TLOGITEMS + 1 ;
+		// Logging
+		uint8_t b ;
+		y = FH ;
+		b = g_model.logRecord ;
+		g_model.logRecord = offonMenuItem( b, y, XPSTR("Record Inputs"), (sub==subN) ? blink : 0 ) ;
+		y += FH ;
+		subN += 1 ;
+		b = g_model.logBinary ;
+		g_model.logBinary = offonMenuItem( b, y, XPSTR("Binary Log"), (sub==subN) ? blink : 0 ) ;
+	}
+	else
+	{
+		uint8_t subN = TDATAITEMS - NUM_LOG_FIELDS + 1 ;
+		// Binary log fields, none selected logs all the telemetry at 20Hz
+		lcd_puts_P( 12*FW, 0, XPSTR("Log Fields") ) ;
+		y = FH ;
+		for ( uint8_t i = 0 ; i < NUM_LOG_FIELDS ; i += 1 )
+		{
+			LogFieldData *pf = &g_model.logFields[i] ;
+			uint8_t attr0 = 0 ;
+			uint8_t attr1 = 0 ;
+			if ( sub == subN )
+			{
+				Columns = 1 ;
+				if ( subSub == 0 )
+				{
+					attr0 = blink ;
+					CHECK_INCDEC_H_MODELVAR_0( pf->item, LOG_NUM_ITEMS ) ;
+				}
+				else
+				{
+					attr1 = blink ;
+					CHECK_INCDEC_H_MODELVAR_0( pf->rate, LOG_NUM_RATES-1 ) ;
+				}
+			}
+			lcd_putc( 0, y, '1'+i ) ;
+			if ( pf->item )
+			{
+				char name[8] ;
+				logItemName( pf->item - 1, name ) ;
+				lcd_putsAtt( 3*FW, y, name, attr0 ) ;
+			}
+			else
+			{
+				lcd_putsAtt( 3*FW, y, XPSTR("---"), attr0 ) ;
+			}
+			lcd_putsAttIdx( 12*FW, y, XPSTR("\0041Hz 2Hz 5Hz 10Hz20Hz50Hz"), pf->rate, attr1 ) ;
+			y += FH ;
+			subN += 1 ;
+		}
+	}
 
 }
 
@@ -4264,6 +4333,7 @@ void insertMix(uint8_t idx, uint8_t copy)
 			md->lateOffset  = 1 ;
 		}
 		s_currMixIdx = idx ;
+		invalidateMixPlan() ;
 //    eeWaitComplete() ;
 }
 
@@ -5311,6 +5381,7 @@ void menuDeleteMix(uint8_t event)
 			if (mixToDelete == 0xFF)
 			{
         clearMixes() ;
+		    STORE_MODELVARS;
 			}
 			else
 			{
@@ -5824,6 +5895,110 @@ int16_t expo(int16_t x, int16_t k)
     return neg? -y:y;
 }
 
+// Expo curves for the model, linearly interpolated.
+// The cubic is flat enough that interpolating every 8th point stays
+// within +/-1 of expo() over 0..RESX.
+// buildExpoTables() makes a table for each stick expo (every channel,
+// dual rate state and direction) and each expo mix curve when the model is
+// loaded or edited.  Sources with the same expo value share a table.  An
+// expo with no table (GVAR driven, or more values than EXPO_TABLES) uses
+// expo() directly; the mixer never builds a table.
+#define EXPO_TABLES		8
+#define EXPO_SHIFT		3
+#define EXPO_POINTS		((RESX >> EXPO_SHIFT) + 1)
+
+struct t_expoTable
+{
+	int16_t y[EXPO_POINTS] ;
+} ;
+
+struct t_expoTable ExpoTables[EXPO_TABLES] ;
+uint8_t ExpoTableCount ;
+uint8_t ExpoTableSlot[201] ;		// Indexed by k+100, table number+1, 0 if none
+
+static void addExpoTable( int8_t k )
+{
+	struct t_expoTable *pt ;
+	uint32_t i ;
+
+	if ( ( k == 0 ) || ( k < -100 ) || ( k > 100 ) )
+	{
+		return ;		// No expo, or a GVAR reference
+	}
+	if ( ExpoTableSlot[k+100] || ( ExpoTableCount >= EXPO_TABLES ) )
+	{
+		return ;
+	}
+	pt = &ExpoTables[ExpoTableCount] ;
+	for ( i = 0 ; i < EXPO_POINTS ; i += 1 )
+	{
+		pt->y[i] = expo( i << EXPO_SHIFT, k ) ;
+	}
+	ExpoTableCount += 1 ;
+	ExpoTableSlot[k+100] = ExpoTableCount ;
+}
+
+void buildExpoTables()
+{
+	uint32_t i ;
+	uint32_t j ;
+
+	memset( ExpoTableSlot, 0, sizeof(ExpoTableSlot) ) ;
+	ExpoTableCount = 0 ;
+	// Normal rates first, they are the most likely to be in use
+	for ( j = 0 ; j < 3 ; j += 1 )
+	{
+		for ( i = 0 ; i < 4 ; i += 1 )
+		{
+			addExpoTable( g_model.expoData[i].expo[j][DR_EXPO][DR_RIGHT] ) ;
+			addExpoTable( g_model.expoData[i].expo[j][DR_EXPO][DR_LEFT] ) ;
+		}
+	}
+	for ( i = 0 ; i < MAX_SKYMIXERS ; i += 1 )
+	{
+		SKYMixData *md = &g_model.mixData[i] ;
+		if ( (md->destCh==0) || (md->destCh>NUM_SKYCHNOUT) )
+		{
+			break ;
+		}
+		if ( md->curve <= -28 )
+		{
+			addExpoTable( md->curve + 128 ) ;
+		}
+	}
+}
+
+int16_t expoLookup( int16_t x, int8_t k )
+{
+	if ( k == 0 )
+	{
+		return x ;
+	}
+	bool neg = x < 0 ;
+	if ( neg )
+	{
+		x = -x ;
+	}
+	uint32_t slot = 0 ;
+	if ( ( k >= -100 ) && ( k <= 100 ) )
+	{
+		slot = ExpoTableSlot[k+100] ;
+	}
+	if ( ( x > RESX ) || ( slot == 0 ) )
+	{
+		return expo( neg ? -x : x, k ) ;
+	}
+	int16_t *table = ExpoTables[slot-1].y ;
+	uint32_t index = x >> EXPO_SHIFT ;
+	int32_t y = table[index] ;
+	uint32_t frac = x & ( (1 << EXPO_SHIFT) - 1 ) ;
+	if ( frac )
+	{
+		y += ( ( table[index+1] - y ) * (int32_t)frac + (1 << (EXPO_SHIFT-1)) ) >> EXPO_SHIFT ;
+	}
+	return neg ? -y : y ;
+}
+
 
 #ifdef EXTENDED_EXPO
 /// expo with y-offset
@@ -7725,6 +7900,12 @@ void menuProcModelSelect(uint8_t event)
 
   int8_t  sub    = mstate2.m_posVert;
   static uint8_t sel_editMode;
+#ifdef PCBSKY
+	if ( ( sub != g_eeGeneral.currModel ) && eeModelExists( sub ) )
+	{
+		ee32PrefetchModel( sub ) ;		// Read it while the user decides
+	}
+#endif
   if ( DupIfNonzero == 2 )
   {
       sel_editMode = false ;
@@ -8840,7 +9021,7 @@ void menuProcSetup2(uint8_t event)
 #endif
 	uint32_t j ;
 //  MENU(PSTR(STR_MEMORY_STAT), menuTabDiag, e_Setup2, 15, {0/*, 0*/});
-	MENU(PSTR(STR_MEMORY_STAT), menuTabStat, e_Setup2, 27, {0} ) ;
+	MENU(PSTR(STR_MEMORY_STAT), menuTabStat, e_Setup2, 28, {0} ) ;
 	
 	int8_t  sub    = mstate2.m_posVert;
 //	uint8_t subSub = mstate2.m_posHorz;
@@ -8850,16 +9031,16 @@ void menuProcSetup2(uint8_t event)
 //	evalOffset(sub);
 
 	j = sub + 1 ;
-	if ( j > 27 )
+	if ( j > 28 )
 	{
-		j = 27 ;
+		j = 28 ;
 	}
 	lcd_puts_Pleft( 1*FH, PSTR(STR_GENERAL));
 #ifdef PCBSKY
   lcd_outhex4( 8*FW+3, 1*FH, File_system[0].block_no ) ;
   lcd_outhex4( 12*FW+3, 1*FH, File_system[0].sequence_no ) ;
   lcd_outhex4( 16*FW+3, 1*FH, File_system[0].size ) ;
-	for ( i = 1 ; i < 7 ; i += 1 )
+	for ( i = 1 ; i < 6 ; i += 1 )
 	{
 		lcd_puts_Pleft( (i+1)*FH, PSTR(STR_Model));
 		lcd_putc( 5*FW, (i+1)*FH, j/10 + '0' ) ;
@@ -8869,6 +9050,16 @@ void menuProcSetup2(uint8_t event)
   	lcd_outhex4( 16*FW+3, (i+1)*FH, File_system[j].size ) ;
 		j += 1 ;
 	}
+	{
+		extern uint16_t Ee32EraseCount ;
+		extern uint16_t Ee32DeltaCount ;
+		extern uint32_t Ee32BytesWritten ;
+		// Erases, delta writes and total kbytes written since power on
+		lcd_puts_Pleft( 7*FH, XPSTR("E      D      kB") ) ;
+		lcd_outdez( 6*FW, 7*FH, Ee32EraseCount ) ;
+		lcd_outdez( 13*FW, 7*FH, Ee32DeltaCount ) ;
+		lcd_outdez( 21*FW, 7*FH, Ee32BytesWritten >> 10 ) ;
+	}
 #endif
 
 //#ifdef REVX
@@ -9872,6 +10063,8 @@ void trace()   // called in perOut - once every 0.01sec
 uint16_t g_timeMain;
 uint16_t g_timeRfsh ;
 uint16_t g_timeMixer ;
+uint16_t g_timeMixerMax ;
+uint16_t g_timeMixerAvg ;
 uint16_t g_timePXX;
 
 void menuProcStatistic2(uint8_t event)
@@ -9883,6 +10076,11 @@ void menuProcStatistic2(uint8_t event)
   {
     case EVT_KEY_FIRST(KEY_MENU):
       g_timeMain = 0;
+      g_timeMixerMax = 0 ;
+#ifdef PCBSKY
+extern uint16_t PulsesIsrTime[4] ;
+			memset( PulsesIsrTime, 0, sizeof(PulsesIsrTime) ) ;
+#endif
       audioDefevent(AU_MENUS) ;
     break;
     case EVT_KEY_LONG(KEY_MENU):
@@ -9917,6 +10115,11 @@ void menuProcStatistic2(uint8_t event)
 extern uint32_t MixerRate ;
 //	lcd_puts_Pleft( 5*FH, PSTR("Mixer Rate"));
   lcd_outdezAtt(20*FW , 4*FH, MixerRate, 0 ) ;
+	// Right half of the wider screen, as the SKY rows
+  lcd_puts_P( 18*FW, 2*FH, XPSTR("tmixer avg     ms"));
+  lcd_outdezAtt(32*FW , 2*FH, (g_timeMixerAvg)/20 ,PREC2);
+  lcd_puts_P( 18*FW, 3*FH, XPSTR("tmixer max     ms"));
+  lcd_outdezAtt(32*FW , 3*FH, (g_timeMixerMax)/20 ,PREC2);
 
 //	lcd_puts_Pleft( 5*FH, PSTR("Usart Errors"));
 //extern uint32_t USART_ERRORS ;
@@ -9933,6 +10136,14 @@ extern uint32_t MixerRate ;
 	lcd_puts_Pleft( 1*FH, XPSTR("ttimer1        us"));
   lcd_outdezAtt(14*FW , 1*FH, (g_timePXX)/2 ,0);
 #endif
+#ifdef PCBSKY
+  lcd_puts_Pleft( 3*FH, XPSTR("tmixer         ms"));
+  lcd_outdezAtt(14*FW , 3*FH, (g_timeMixerAvg)/20 ,PREC2);
+extern uint32_t MixerRate ;
+  lcd_outdezAtt(20*FW , 3*FH, MixerRate, 0 ) ;
+  lcd_puts_Pleft( 4*FH, XPSTR("tmixer max     ms"));
+  lcd_outdezAtt(14*FW , 4*FH, (g_timeMixerMax)/20 ,PREC2);
+#endif
 
   
 extern uint8_t AudioVoiceCountUnderruns ;
@@ -10109,6 +10320,127 @@ void menuProcTrainDdiag(uint8_t event)
 
 }
 
+extern uint8_t AudioVoiceCountUnderruns ;
+extern uint16_t VoiceAlarmTime ;
+extern uint16_t VoiceAlarmTimeMax ;
+
+void menuProcVoiceDdiag(uint8_t event)
+{
+	MENU(XPSTR("Voice diag"), menuTabStat, e_voicediag, 1, {0} ) ;
+
+  switch(event)
+  {
+    case EVT_KEY_FIRST(KEY_MENU):
+			AudioVoiceCountUnderruns = 0 ;
+			VoicePrefetchHits = 0 ;
+			VoiceQueueDropped = 0 ;
+			VoiceQueueCoalesced = 0 ;
+			VoiceCacheHits = 0 ;
+			VoiceIndexHits = 0 ;
+			VoiceLatencyMax = 0 ;
+			VoiceAlarmTimeMax = 0 ;
+			memset( VoiceLatencyHist, 0, sizeof(VoiceLatencyHist[0]) * VOICE_LATENCY_BUCKETS ) ;
+      audioDefevent(AU_MENUS) ;
+    break;
+  }
+
+	// Queue entries dropped when full and readouts replaced by a newer one
+	lcd_puts_Pleft( 1*FH, XPSTR("Underruns     Drp")) ;
+  lcd_outdezAtt( 13*FW, 1*FH, AudioVoiceCountUnderruns, 0 ) ;
+  lcd_outdezAtt( 21*FW, 1*FH, VoiceQueueDropped > 999 ? 999 : VoiceQueueDropped, 0 ) ;
+	lcd_puts_Pleft( 2*FH, XPSTR("Prefetched    Coa")) ;
+  lcd_outdezAtt( 13*FW, 2*FH, VoicePrefetchHits > 999 ? 999 : VoicePrefetchHits, 0 ) ;
+  lcd_outdezAtt( 21*FW, 2*FH, VoiceQueueCoalesced > 999 ? 999 : VoiceQueueCoalesced, 0 ) ;
+	lcd_puts_Pleft( 3*FH, XPSTR("Start max         ms")) ;
+  lcd_outdezAtt( 18*FW, 3*FH, VoiceLatencyMax * 10, 0 ) ;
+	lcd_puts_Pleft( 4*FH, XPSTR(" <10 <20 <50<100 100+") ) ;
+	for ( uint32_t i = 0 ; i < VOICE_LATENCY_BUCKETS ; i += 1 )
+	{
+		uint16_t count = VoiceLatencyHist[i] ;
+  	lcd_outdezAtt( (i*4+4)*FW + ( i == VOICE_LATENCY_BUCKETS-1 ? FW : 0 ), 5*FH, count > 999 ? 999 : count, 0 ) ;
+	}
+	// Voice alarm check, last and max, MENU clears the counters
+	lcd_puts_Pleft( 6*FH, XPSTR("Alarms        us")) ;
+  lcd_outdezAtt( 13*FW, 6*FH, VoiceAlarmTime/2, 0 ) ;
+  lcd_outdezAtt( 21*FW, 6*FH, VoiceAlarmTimeMax/2, 0 ) ;
+	// Opens from the cache and the index, and files indexed
+	lcd_puts_Pleft( 7*FH, XPSTR("Cache/Idx")) ;
+  lcd_outdezAtt( 13*FW, 7*FH, VoiceCacheHits > 999 ? 999 : VoiceCacheHits, 0 ) ;
+  lcd_outdezAtt( 17*FW, 7*FH, VoiceIndexHits > 999 ? 999 : VoiceIndexHits, 0 ) ;
+  lcd_outdezAtt( 21*FW, 7*FH, VoiceIndexCount, 0 ) ;
+}
+
+#ifdef PCBSKY
+extern uint16_t LatencyMin ;
+extern uint16_t LatencyMax ;
+extern uint32_t LatencySum ;
+extern uint32_t LatencyCount ;
+extern uint16_t PulsesIsrBuilds ;
+
+// Inputs read to pulse frame swapped in, and the mixer lead that sets it
+void menuProcLatency(uint8_t event)
+{
+	MENU(XPSTR("Latency"), menuTabStat, e_latency, 2, {0} ) ;
+
+	int8_t sub = mstate2.m_posVert ;
+
+  switch(event)
+  {
+    case EVT_KEY_LONG(KEY_MENU):
+			LatencyMin = 0xFFFF ;
+			LatencyMax = 0 ;
+			LatencySum = 0 ;
+			LatencyCount = 0 ;
+			PulsesIsrBuilds = 0 ;
+      audioDefevent(AU_MENUS) ;
+			killEvents(event) ;
+    break;
+  }
+
+  lcd_puts_Pleft( 1*FH, XPSTR("Mixer lead")) ;
+	uint8_t b = g_eeGeneral.mixerLead ;
+	if ( b )
+	{
+	  lcd_outdezAtt( 17*FW, 1*FH, b, PREC1|(sub==1 ? BLINK : 0) ) ;
+    lcd_puts_P( 17*FW, 1*FH, XPSTR("ms") ) ;
+	}
+	else
+	{
+		lcd_putsAtt( 15*FW, 1*FH, PSTR(STR_OFF), (sub==1 ? BLINK : 0) ) ;
+	}
+	if ( sub == 1 )
+	{
+		CHECK_INCDEC_H_GENVAR_0( b, 35 ) ;
+		g_eeGeneral.mixerLead = b ;
+	}
+
+	// Last model switch, and how many used the prefetched image
+  lcd_puts_Pleft( 2*FH, XPSTR("Model load     ms")) ;
+	if ( ModelSwitchTime == 0xFFFF )
+	{
+  	lcd_puts_P( 11*FW, 2*FH, XPSTR(">30") ) ;
+	}
+	else
+	{
+  	lcd_outdezAtt( 14*FW, 2*FH, ModelSwitchTime/20, PREC2 ) ;
+	}
+  lcd_outdezAtt( 20*FW, 2*FH, ModelSwitchHits, 0 ) ;
+
+	uint32_t count = LatencyCount ;
+  lcd_puts_Pleft( 3*FH, XPSTR("Latency min    ms")) ;
+  lcd_outdezAtt( 14*FW, 3*FH, count ? LatencyMin/20 : 0, PREC2 ) ;
+  lcd_puts_Pleft( 4*FH, XPSTR("        avg    ms")) ;
+  lcd_outdezAtt( 14*FW, 4*FH, count ? LatencySum / count / 20 : 0, PREC2 ) ;
+  lcd_puts_Pleft( 5*FH, XPSTR("        max    ms")) ;
+  lcd_outdezAtt( 14*FW, 5*FH, LatencyMax/20, PREC2 ) ;
+  lcd_puts_Pleft( 6*FH, XPSTR("Frames")) ;
+  lcd_outdezNAtt( 14*FW, 6*FH, count, 0, 8 ) ;
+	// Frames the mixer hadn't built in time
+  lcd_puts_Pleft( 7*FH, XPSTR("Mixer late")) ;
+  lcd_outdezAtt( 14*FW, 7*FH, PulsesIsrBuilds, 0 ) ;
+}
+#endif
+
 uint16_t DsmFrameRequired ;
 
 void menuProcDsmDdiag(uint8_t event)
@@ -10185,6 +10517,16 @@ extern uint32_t USART_FE ;
 #endif
 
 #ifdef PCBSKY
+	// Pulse frames, worst case interrupt time for this protocol, frames the
+	// interrupt had to build itself and the last build by the mixer task
+extern uint16_t PulsesIsrTime[4] ;
+extern uint16_t PulsesIsrBuilds ;
+extern uint16_t PulsesBuildTime ;
+	lcd_puts_Pleft( 5*FH, XPSTR("Pulses      us")) ;
+  lcd_outdezAtt( 12*FW, 5*FH, PulsesIsrTime[g_model.protocol & 3]/2, 0 ) ;
+  lcd_outdezAtt( 17*FW, 5*FH, PulsesIsrBuilds > 9999 ? 9999 : PulsesIsrBuilds, 0 ) ;
+  lcd_outdezAtt( 21*FW, 5*FH, PulsesBuildTime/2, 0 ) ;
+
 extern uint8_t DsmDebug[20] ;
 extern uint8_t DsmControlDebug[20] ;
 extern uint16_t DsmControlCounter ;
@@ -12184,19 +12526,17 @@ int16_t intpol(int16_t x, uint8_t idx) // -100, -75, -50, -25, 0 ,25 ,50, 75, 10
     } else if(x >= (RESX*2)) {
         erg = (int16_t)crv[(cv9 ? 8 : 4)] * (RESX/4);
     } else {
-				div_t qr ;
-//        int16_t a,dx;
+				// D9 and D5 are powers of 2, x is 0 to 2*RESX-1 here
+				uint32_t a ;
+				uint32_t dx ;
         if(cv9){
-						qr = div( x, D9 ) ;
-						qr.rem *= 2 ;
-//            a   = (uint16_t)x / D9;
-//            dx  =((uint16_t)x % D9) * 2;
+						a = (uint16_t)x >> 8 ;				// x / D9
+						dx = ((uint16_t)x & (D9-1)) * 2 ;
         } else {
-						qr = div( x, D5 ) ;
-//            a   = (uint16_t)x / D5;
-//            dx  = (uint16_t)x % D5;
+						a = (uint16_t)x >> 9 ;				// x / D5
+						dx = (uint16_t)x & (D5-1) ;
         }
-        erg  = (int16_t)crv[qr.quot]*((D5-qr.rem)/2) + (int16_t)crv[qr.quot+1]*(qr.rem/2);
+        erg  = (int16_t)crv[a]*(int16_t)((D5-dx)/2) + (int16_t)crv[a+1]*(int16_t)(dx/2);
     }
     return erg / 25; // 100*D5/RESX;
 }
@@ -12208,11 +12548,11 @@ int16_t calcExpo( uint8_t channel, int16_t value )
 
   if(IS_THROTTLE(channel) && g_model.thrExpo)
 	{
-    value  = 2*expo((value+RESX)/2,REG(g_model.expoData[channel].expo[expoDrOn][DR_EXPO][DR_RIGHT], -100, 100)) ;
+    value  = 2*expoLookup((value+RESX)/2,REG(g_model.expoData[channel].expo[expoDrOn][DR_EXPO][DR_RIGHT], -100, 100)) ;
     stkDir = DR_RIGHT ;
   }
   else
-    value  = expo(value,REG(g_model.expoData[channel].expo[expoDrOn][DR_EXPO][stkDir], -100, 100)) ;
+    value  = expoLookup(value,REG(g_model.expoData[channel].expo[expoDrOn][DR_EXPO][stkDir], -100, 100)) ;
 
   value = (int32_t)value * (REG(g_model.expoData[channel].expo[expoDrOn][DR_WEIGHT][stkDir]+100, 0, 100))/100 ;
   if (IS_THROTTLE(channel) && g_model.thrExpo) value -= RESX;
@@ -12237,11 +12577,190 @@ uint8_t  swOn  [MAX_SKYMIXERS] = {0};
 uint8_t	CurrentPhase = 0 ;
 int16_t rawSticks[4] ;
 
+// Mixer plan, the active mixer lines with their sources decoded.
+// Rebuilt by perOut() after invalidateMixPlan(), which is called whenever
+// the model is loaded or edited.
+#define MPS_NONE		0		// No source
+#define MPS_ANA			1		// anas[]
+#define MPS_STICK		2		// anas[] or rawSticks[] with expo/dr disabled
+#define MPS_3POS		3		// Switch as source
+#define MPS_CHOUT		4		// Output channel
+#define MPS_THIS		5		// This channel
+#define MPS_SCALER	6
+#define MPS_PPM16		7		// Extra PPM inputs (9-16)
+#define MPS_POT			8		// Extra pots
+
+#define MPF_PPM_GATED	0x01	// Switched line using a PPM input, off when ppm invalid
+#define MPF_DELAY			0x02	// Has delay or slow values
+#define MPF_TRIM			0x04	// Add the stick trim
+#define MPF_CHAN_DONE	0x08	// Source channel is evaluated before this line
+
+struct t_mixPlanLine
+{
+	SKYMixData *md ;
+	uint8_t srcType ;
+	uint8_t srcIndex ;
+	uint8_t flags ;
+	uint8_t destIndex ;
+} ;
+
+struct t_mixPlan
+{
+	uint8_t valid ;
+	uint8_t count ;
+	uint8_t phaseGroup[MAX_MODES+1] ;		// Phases with the same group switch the same mixer lines
+	struct t_mixPlanLine line[MAX_SKYMIXERS] ;
+} MixPlan ;
+
+void invalidateMixPlan()
+{
+	MixPlan.valid = 0 ;
+}
+
+static void buildMixPlan()
+{
+	struct t_mixPlanLine *pl = MixPlan.line ;
+	uint8_t i ;
+
+	for ( i = 0 ; i < MAX_SKYMIXERS ; i += 1 )
+	{
+		SKYMixData *md = &g_model.mixData[i] ;
+		if ( (md->destCh==0) || (md->destCh>NUM_SKYCHNOUT) )
+		{
+			break ;
+		}
+		uint8_t k = md->srcRaw ;
+		uint8_t type ;
+		uint8_t index ;
+		uint8_t flags = 0 ;
+
+		if ( md->swtch )
+		{
+			if ( (k >= PPM_BASE) && (k < PPM_BASE+NUM_PPM) )
+			{
+				flags = MPF_PPM_GATED ;
+			}
+			if ( (k > MIX_3POS+MAX_GVARS + NUM_SCALERS ) && (k <= MIX_3POS+MAX_GVARS + NUM_SCALERS + NUM_EXTRA_PPM ) )
+			{
+				flags = MPF_PPM_GATED ;
+			}
+		}
+		if (md->speedUp || md->speedDown || md->delayUp || md->delayDown)
+		{
+			flags |= MPF_DELAY ;
+		}
+		if ( (md->carryTrim==0) && (k>0) && (k<=4) )
+		{
+			flags |= MPF_TRIM ;
+		}
+
+		index = k - 1 ;
+		if ( k == 0 )
+		{
+			type = MPS_NONE ;
+		}
+		else if ( index < 4 )
+		{
+			type = MPS_STICK ;
+		}
+		else if ( index == MIX_3POS-1 )
+		{
+			type = MPS_3POS ;
+			index = md->switchSource ;
+		}
+		else if ( (index >= CHOUT_BASE) && (index < CHOUT_BASE+NUM_SKYCHNOUT) )
+		{
+			type = MPS_CHOUT ;
+			index -= CHOUT_BASE ;
+			if ( index < md->destCh-1 )
+			{
+				flags |= MPF_CHAN_DONE ;
+			}
+		}
+		else if ( index == MIX_3POS+MAX_GVARS )
+		{
+			type = MPS_THIS ;
+		}
+		else if ( index > MIX_3POS+MAX_GVARS + NUM_SCALERS + NUM_EXTRA_PPM )
+		{
+			type = MPS_POT ;
+			index = index - EXTRA_POTS_START + 8 ;
+		}
+		else if ( index > MIX_3POS+MAX_GVARS + NUM_SCALERS )
+		{
+			type = MPS_PPM16 ;
+			index = index - (MIX_3POS+MAX_GVARS + NUM_SCALERS + 1) + 8 ;
+		}
+		else if ( index > MIX_3POS+MAX_GVARS )
+		{
+			type = MPS_SCALER ;
+			index -= MIX_3POS+MAX_GVARS+1 ;
+		}
+		else
+		{
+			type = MPS_ANA ;
+		}
+		pl->md = md ;
+		pl->srcType = type ;
+		pl->srcIndex = index ;
+		pl->flags = flags ;
+		pl->destIndex = md->destCh - 1 ;
+		pl += 1 ;
+	}
+	MixPlan.count = i ;
+
+	// Group the flight phases by which lines they disable through modeControl
+	uint64_t lines[MAX_MODES+1] ;
+	uint8_t p ;
+	for ( p = 0 ; p < MAX_MODES+1 ; p += 1 )
+	{
+		uint64_t x = 0 ;
+		for ( i = 0 ; i < MixPlan.count ; i += 1 )
+		{
+			if ( MixPlan.line[i].md->modeControl & ( 1 << p ) )
+			{
+				x |= (uint64_t)1 << i ;
+			}
+		}
+		lines[p] = x ;
+		MixPlan.phaseGroup[p] = p ;
+		for ( i = 0 ; i < p ; i += 1 )
+		{
+			if ( lines[i] == x )
+			{
+				MixPlan.phaseGroup[p] = MixPlan.phaseGroup[i] ;
+				break ;
+			}
+		}
+	}
+	MixPlan.valid = 1 ;
+}
+
+// A phase gives the same mixer output as another if it switches the same
+// mixer lines and uses the same trims, so it needn't be evaluated separately
+// while fading.
+static uint8_t samePhaseOutput( uint8_t p, uint8_t q )
+{
+	if ( MixPlan.phaseGroup[p] != MixPlan.phaseGroup[q] )
+	{
+		return 0 ;
+	}
+	for ( uint8_t i = 0 ; i < 4 ; i += 1 )
+	{
+		if ( getTrimValue( p, i ) != getTrimValue( q, i ) )
+		{
+			return 0 ;
+		}
+	}
+	return 1 ;
+}
+
 struct t_fade
 {
 uint8_t  fadePhases ;
 uint16_t fadeRate ;
-uint16_t fadeWeight ;
+uint32_t fadeWeight ;
+uint32_t evalScale ;		// Weight of the phase(s) being evaluated by perOut()
 uint16_t fadeScale[MAX_MODES+1] ;
 int32_t  fade[NUM_SKYCHNOUT];
 } Fade ;
@@ -12317,9 +12836,14 @@ void perOutPhase( int16_t *chanOut, uint8_t att )
 		lastPhase = thisPhase ;
 	}
 	att |= FADE_FIRST ;
+	uint32_t thisScale = 0 ;
 	if ( pFade->fadePhases )
 	{
 		pFade->fadeWeight = 0 ;
+		if ( MixPlan.valid == 0 )
+		{
+			buildMixPlan() ;
+		}
 		uint8_t fadeMask = 1 ;
     for (uint8_t p=0; p<MAX_MODES+1; p++)
 		{
@@ -12327,10 +12851,19 @@ void perOutPhase( int16_t *chanOut, uint8_t att )
 			{
 				if ( p != thisPhase )
 				{
-					CurrentPhase = p ;
-					pFade->fadeWeight += pFade->fadeScale[p] ;
-					perOut( chanOut, att ) ;
-					att &= ~FADE_FIRST ;				
+					if ( samePhaseOutput( p, thisPhase ) )
+					{
+						// Blend in with the current phase, no extra mixer pass
+						thisScale += pFade->fadeScale[p] ;
+					}
+					else
+					{
+						CurrentPhase = p ;
+						pFade->evalScale = pFade->fadeScale[p] ;
+						pFade->fadeWeight += pFade->fadeScale[p] ;
+						perOut( chanOut, att ) ;
+						att &= ~FADE_FIRST ;
+					}
 				}
 			}
 			fadeMask <<= 1 ;
@@ -12340,7 +12873,9 @@ void perOutPhase( int16_t *chanOut, uint8_t att )
 	{
 		pFade->fadeScale[thisPhase] = 25600 ;
 	}
-	pFade->fadeWeight += pFade->fadeScale[thisPhase] ;
+	thisScale += pFade->fadeScale[thisPhase] ;
+	pFade->evalScale = thisScale ;
+	pFade->fadeWeight += thisScale ;
 	CurrentPhase = thisPhase ;
 	perOut( chanOut, att | FADE_LAST ) ;
 	
@@ -12774,33 +13309,27 @@ void perOut(int16_t *chanOut, uint8_t att )
 //    TrimPtr[2] = &g_model.trim[2] ;
 //    TrimPtr[3] = &g_model.trim[3] ;
 
-    for(uint8_t i=0;i<MAX_SKYMIXERS;i++)
+		if ( MixPlan.valid == 0 )
 		{
-//        MixData *md = mixaddress( i ) ;
-        SKYMixData *md = &g_model.mixData[i] ;
+			buildMixPlan() ;
+		}
+		struct t_mixPlanLine *pl = MixPlan.line ;
+    for(uint8_t i=0;i<MixPlan.count;i++, pl++)
+		{
+        SKYMixData *md = pl->md ;
 				int8_t mixweight = REG( md->weight, -100, 100 ) ;
 
-        if((md->destCh==0) || (md->destCh>NUM_SKYCHNOUT)) break;
-
         //Notice 0 = NC switch means not used -> always on line
         int16_t v  = 0;
         uint8_t swTog;
         uint8_t swon = swOn[i] ;
 				
 				bool t_switch = getSwitch(md->swtch,1) ;
-        if (md->swtch && (md->srcRaw >= PPM_BASE) && (md->srcRaw < PPM_BASE+NUM_PPM)	&& (ppmInValid == 0) )
+        if ( (pl->flags & MPF_PPM_GATED) && (ppmInValid == 0) )
 				{
 					// then treat switch as false ???				
 					t_switch = 0 ;
 				}	
-        if (md->swtch && (md->srcRaw > MIX_3POS+MAX_GVARS + NUM_SCALERS ) && (ppmInValid == 0) )
-				{ // Extra PPM inputs (9-16)
-					if (md->srcRaw <= MIX_3POS+MAX_GVARS + NUM_SCALERS + NUM_EXTRA_PPM )
-					{
-						// then treat switch as false ???				
-						t_switch = 0 ;
-					}
-				}
       
         if ( t_switch )
 				{
@@ -12818,7 +13347,7 @@ void perOut(int16_t *chanOut, uint8_t att )
         { // switch on?  if no switch selected => on
             swTog = swon ;
             swOn[i] = swon = false ;
-            if (k == MIX_3POS+MAX_GVARS+1) act[i] = chans[md->destCh-1] * DEL_MULT / 100 ;
+            if (pl->srcType == MPS_THIS) act[i] = chans[pl->destIndex] * DEL_MULT / 100 ;
             if( k !=MIX_MAX && k !=MIX_FULL) continue;// if not MAX or FULL - next loop
             if(md->mltpx==MLTPX_REP) continue; // if switch is off and REPLACE then off
             v = ( k == MIX_FULL ? -RESX : 0); // switch is off and it is either MAX=0 or FULL=-512
@@ -12826,91 +13355,84 @@ void perOut(int16_t *chanOut, uint8_t att )
         else {
             swTog = !swon ;
             swon = true;
-            k -= 1 ;
-						v = anas[k]; //Switch is on. MAX=FULL=512 or value.
-						if ( k < 4 )
+						k = pl->srcIndex ;
+						switch ( pl->srcType )
 						{
-							if ( md->disableExpoDr )
-							{
-     		      	v = rawSticks[k]; //Switch is on. MAX=FULL=512 or value.
-							}
-						}
+							case MPS_STICK :
+								v = ( md->disableExpoDr ) ? rawSticks[k] : anas[k] ; //Switch is on. MAX=FULL=512 or value.
+							break ;
+
+							case MPS_ANA :
+								v = anas[k]; //Switch is on. MAX=FULL=512 or value.
+							break ;
+
+							case MPS_3POS :
 #ifdef PCBX9D
-						if ( k == MIX_3POS-1 )
-						{
-							uint32_t /*EnumKeys*/ sw = switchIndex[md->switchSource] ;
-							if ( ( md->switchSource == 5) || ( md->switchSource == 7) )
-							{ // 2-POS switch
-        				v = hwKeyState(sw) ? 1024 : -1024 ;
-//        				v = keyState(sw) ? -1024 : 1024 ;
-							}
-							else if( md->switchSource == 8)
 							{
-								v = ((int32_t)switchPosition( HSW_Ele6pos0 ) * 2048 - 5120)/5 ;
-							}
-							else
-							{ // 3-POS switch
-        				v = hwKeyState(sw) ? -1024 : (hwKeyState(sw+1) ? 0 : 1024) ;
-//        				v = keyState(sw) ? -1024 : (keyState((EnumKeys)(sw+1)) ? 0 : 1024) ;
+								uint32_t /*EnumKeys*/ sw = switchIndex[k] ;
+								if ( ( k == 5) || ( k == 7) )
+								{ // 2-POS switch
+        					v = hwKeyState(sw) ? 1024 : -1024 ;
+								}
+								else if( k == 8)
+								{
+									v = ((int32_t)switchPosition( HSW_Ele6pos0 ) * 2048 - 5120)/5 ;
+								}
+								else
+								{ // 3-POS switch
+        					v = hwKeyState(sw) ? -1024 : (hwKeyState(sw+1) ? 0 : 1024) ;
+								}
 							}
-						}
 #endif
 #ifdef PCBSKY
-						if ( k == MIX_3POS-1 )
-						{
-							uint32_t sw = Sw3PosList[md->switchSource] ;
-							if ( Sw3PosCount[md->switchSource] == 2 )
-							{
-        				v = hwKeyState(sw) ? 1024 : -1024 ;
-							}
-							else if ( Sw3PosCount[md->switchSource] == 6 )
-							{
-								v = ((int32_t)switchPosition( HSW_Ele6pos0 ) * 2048 - 5120)/5 ;
-							}
-							else
 							{
-        				v = hwKeyState(sw) ? -1024 : (hwKeyState(sw+1) ? 0 : 1024) ;
+								uint32_t sw = Sw3PosList[k] ;
+								if ( Sw3PosCount[k] == 2 )
+								{
+        					v = hwKeyState(sw) ? 1024 : -1024 ;
+								}
+								else if ( Sw3PosCount[k] == 6 )
+								{
+									v = ((int32_t)switchPosition( HSW_Ele6pos0 ) * 2048 - 5120)/5 ;
+								}
+								else
+								{
+        					v = hwKeyState(sw) ? -1024 : (hwKeyState(sw+1) ? 0 : 1024) ;
+								}
 							}
-						}
 #endif
-//            if(k>=CHOUT_BASE && (k<i)) v = chans[k]; // if we've already calculated the value - take it instead // anas[i+CHOUT_BASE] = chans[i]
-						if ( k >= CHOUT_BASE )
-            {
-							if(k<CHOUT_BASE+NUM_SKYCHNOUT)
-							{
+							break ;
+
+							case MPS_CHOUT :
 								if ( md->disableExpoDr )
 								{
-									v = g_chans512[k-CHOUT_BASE] ;
+									v = g_chans512[k] ;
+								}
+								else if ( pl->flags & MPF_CHAN_DONE )
+								{
+									v = chans[k] / 100 ; // if we've already calculated the value - take it instead
 								}
 								else
 								{
-            			if(k<CHOUT_BASE+md->destCh-1)
-									{
-										v = chans[k-CHOUT_BASE] / 100 ; // if we've already calculated the value - take it instead // anas[i+CHOUT_BASE] = chans[i]
-									}
-									else
-									{
-										v = ex_chans[k-CHOUT_BASE] ;
-									}
+									v = ex_chans[k] ;
 								}
-							}
-						}
-						if (k == MIX_3POS+MAX_GVARS) v = chans[md->destCh-1] / 100 ;	// "THIS"
-            if ( (k > MIX_3POS+MAX_GVARS) && ( k <= MIX_3POS+MAX_GVARS + NUM_SCALERS ) )
-						{
-							 v = calc_scaler( k - (MIX_3POS+MAX_GVARS+1), 0, 0 ) ;
-            }
-            if (k > MIX_3POS+MAX_GVARS + NUM_SCALERS)
-						{
-							if ( k <= MIX_3POS+MAX_GVARS + NUM_SCALERS + NUM_EXTRA_PPM )
-							{
-								v = g_ppmIns[k-(MIX_3POS+MAX_GVARS + NUM_SCALERS + 1) + 8]*2 ;
-							}
-							else	// ( k >= EXTRA_POTS_START )
-							{
-								// An extra pot
-								v = calibratedStick[k-EXTRA_POTS_START+8] ;
-							}
+							break ;
+
+							case MPS_THIS :
+								v = chans[pl->destIndex] / 100 ;
+							break ;
+
+							case MPS_SCALER :
+								v = calc_scaler( k, 0, 0 ) ;
+							break ;
+
+							case MPS_PPM16 :
+								v = g_ppmIns[k]*2 ;
+							break ;
+
+							case MPS_POT :
+								v = calibratedStick[k] ;
+							break ;
 						}
 						if(md->mixWarn) mixWarning |= 1<<(md->mixWarn-1); // Mix warning
 //            if ( md->enableFmTrim )
@@ -12935,7 +13457,7 @@ void perOut(int16_t *chanOut, uint8_t att )
         }
 
         //========== DELAY and PAUSE ===============
-        if (md->speedUp || md->speedDown || md->delayUp || md->delayDown)  // there are delay values
+        if ( pl->flags & MPF_DELAY )  // there are delay values
         {
 
 					int16_t my_delay = sDelay[i] ;
@@ -12970,7 +13492,7 @@ void perOut(int16_t *chanOut, uint8_t att )
                 // v * weight / 100 = anas => anas*100/weight = v
                 if(md->mltpx==MLTPX_REP)
                 {
-                    tact = (int32_t)anas[md->destCh-1+CHOUT_BASE]*DEL_MULT * 100;
+                    tact = (int32_t)anas[pl->destIndex+CHOUT_BASE]*DEL_MULT * 100;
                     if(mixweight) tact /= mixweight ;
                 }
                 diff = v-tact/DEL_MULT;
@@ -13059,7 +13581,7 @@ void perOut(int16_t *chanOut, uint8_t att )
 					if ( md->curve <= -28 )
 					{
 						// do expo using md->curve + 128
-      			v = expo( v, md->curve + 128 ) ;
+      			v = expoLookup( v, md->curve + 128 ) ;
 					}
 					else
 					{
@@ -13111,7 +13633,7 @@ void perOut(int16_t *chanOut, uint8_t att )
 				}
 
         //========== TRIM ===============
-        if((md->carryTrim==0) && (md->srcRaw>0) && (md->srcRaw<=4)) v += trimA[md->srcRaw-1];  //  0 = Trim ON  =  Default
+        if ( pl->flags & MPF_TRIM ) v += trimA[md->srcRaw-1];  //  0 = Trim ON  =  Default
 
         //========== MULTIPLEX ===============
 #if GVARS
@@ -13132,7 +13654,7 @@ void perOut(int16_t *chanOut, uint8_t att )
         }
 				
 				int32_t *ptr ;			// Save calculating address several times
-				ptr = &chans[md->destCh-1] ;
+				ptr = &chans[pl->destIndex] ;
         switch((uint8_t)md->mltpx){
         case MLTPX_REP:
             *ptr = dv;
@@ -13185,14 +13707,14 @@ void perOut(int16_t *chanOut, uint8_t att )
 					{
 						l_fade = 0 ;
 					}
-					l_fade += ( q / 100 ) * Fade.fadeScale[CurrentPhase] ;
+					l_fade += ( q / 100 ) * (int32_t)Fade.evalScale ;
 					Fade.fade[i] = l_fade ;
 			
 					if ( ( att & FADE_LAST ) == 0 )
 					{
 						continue ;
 					}
-					l_fade /= Fade.fadeWeight ;
+					l_fade /= (int32_t)Fade.fadeWeight ;
 					q = l_fade * 100 ;
 				}
     	  chans[i] = q / 100 ; // chans back to -1024..1024
@@ -13416,6 +13938,21 @@ extern uint32_t SDlastError ;
 		  lcd_outhex4( x+4*FW, y, Card_SCR[i] ) ;
 			x += 8*FW ;
 		}
+		{
+extern uint32_t SdReadCommands ;
+extern uint32_t SdReadBlocks ;
+extern uint32_t SdWriteCommands ;
+extern uint32_t SdWriteBlocks ;
+			lcd_puts_Pleft( 7*FH, XPSTR("Rd     Wr     blk/cmd"));
+			if ( SdReadCommands )
+			{
+			  lcd_outdezAtt( 7*FW, 7*FH, SdReadBlocks * 10 / SdReadCommands, PREC1 ) ;
+			}
+			if ( SdWriteCommands )
+			{
+			  lcd_outdezAtt( 14*FW, 7*FH, SdWriteBlocks * 10 / SdWriteCommands, PREC1 ) ;
+			}
+		}
 #endif
 	if (sd_card_ready() )
 	{
@@ -14211,8 +14748,8 @@ Str_DiagAna
 				displayNext() ;
 #endif
         lcd_puts_Pleft( y,PSTR(STR_FILTER_ADC));
-        lcd_putsAttIdx(PARAM_OFS, y, XPSTR("\004SINGOSMPFILT"),g_eeGeneral.filterInput,(sub==subN ? blink:0));
-        if(sub==subN) CHECK_INCDEC_H_GENVAR_0( g_eeGeneral.filterInput, 2);
+        lcd_putsAttIdx(PARAM_OFS, y, XPSTR("\004SINGOSMPFILTCHAN"),g_eeGeneral.filterInput,(sub==subN ? blink:0));
+        if(sub==subN) CHECK_INCDEC_H_GENVAR_0( g_eeGeneral.filterInput, 3);
  				y += FH ;
 				subN += 1 ;
 
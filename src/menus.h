@@ -155,6 +155,8 @@ extern void menuProc0(uint8_t event) ;
 extern void menuProcModelSelect(uint8_t event) ;
 extern void perOutPhase( int16_t *chanOut, uint8_t att ) ;
 extern void perOut( int16_t *chanOut, uint8_t att ) ;
+extern void invalidateMixPlan( void ) ;
+extern void buildExpoTables( void ) ;
 extern void menuProcGlobals(uint8_t event) ;
 
 extern void menuUp1(uint8_t event) ;
@@ -44,6 +44,7 @@
 #define NUM_VOICE_ALARMS	24
 
 #define NUM_GVAR_ADJUST	8
+#define NUM_LOG_FIELDS	6
 
 //OBSOLETE - USE ONLY MDVERS NOW
 //#define GENERAL_MYVER_r261 3
@@ -189,6 +190,7 @@ PACK(typedef struct t_EEGeneral {
 	uint8_t		geasource ;
 	uint8_t		thrsource ;
 	uint8_t		elesource ;
+	uint8_t		mixerLead ;			// Run mixer this long before each pulse frame, 0.1mS, 0 = free running
 }) EEGeneral;
 
 
@@ -506,6 +508,12 @@ typedef struct t_voiceAlarm
 	} file ;
 } VoiceAlarmData ;
 
+typedef struct t_logFieldData
+{
+	uint8_t item ;				// 0 unused, else LogItems + 1
+	uint8_t rate ;				// 1, 2, 5, 10, 20, 50Hz
+} LogFieldData ;
+
 typedef struct t_gvarAdjust
 {
 	uint8_t function:4 ;
@@ -633,7 +641,11 @@ PACK(typedef struct te_ModelData {
   uint8_t ymodelswitchWarningStates ;	// Enough bits for Taranis X9E
 	uint8_t customDisplay2Index[6] ;
 	GvarAdjust gvarAdjuster[NUM_GVAR_ADJUST] ;
-	uint8_t forExpansion[20] ;	// Allows for extra items not yet handled
+	uint8_t logRecord:1 ;			// Record inputs to a .rec file while logging
+	uint8_t logBinary:1 ;			// Write a binary .blg log instead of .csv
+	uint8_t logSpare:6 ;
+	LogFieldData logFields[NUM_LOG_FIELDS] ;	// Binary log fields
+	uint8_t forExpansion[7] ;	// Allows for extra items not yet handled
 }) SKYModelData;
 
 
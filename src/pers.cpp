@@ -211,6 +211,9 @@ void eeReadAll()
 }
 
 
+extern void invalidateMixPlan( void ) ;
+extern void buildExpoTables( void ) ;
+
 void eeDirty(uint8_t msk)
 {
   if(!msk) return;
@@ -222,6 +225,11 @@ void eeDirty(uint8_t msk)
 	}
 	if ( msk & EE_MODEL )
 	{
+		invalidateMixPlan() ;
+		if ( ( msk & EE_TRIM ) == 0 )
+		{
+			buildExpoTables() ;		// A trim store doesn't change the expos
+		}
 		ee32StoreModel( g_eeGeneral.currModel, msk & EE_TRIM ) ;
 	}
 
@@ -52,6 +52,7 @@
 #include "AT91SAM3S4.h"
 #ifndef SIMU
 #include "core_cm3.h"
+#include "CoOS.h"
 #endif
 
 #include "ersky9x.h"
@@ -81,7 +82,7 @@
 //}
 //#endif
 
-uint8_t Bit_pulses[64] ;			// Likely more than we need
+uint8_t Bit_pulses[3][64] ;			// Likely more than we need
 uint8_t *Pulses2MHzptr ;
 
 uint8_t Serial_byte ;
@@ -96,11 +97,66 @@ uint8_t DsmInitCounter = 0 ;
 //uint8_t Dsm_9xr_10bit = 0 ;				// 0 for 11 bit, 1 for 10 bit
 //uint8_t Dsm_mode_response = 0 ;
 
-uint16_t Pulses[18] = {	2000, 2200, 2400, 2600, 2800, 3000, 3200, 3400, 9000, 0, 0, 0,0,0,0,0,0, 0 } ;
+uint16_t Pulses[3][18] = { {	2000, 2200, 2400, 2600, 2800, 3000, 3200, 3400, 9000, 0, 0, 0,0,0,0,0,0, 0 },
+														{	2000, 2200, 2400, 2600, 2800, 3000, 3200, 3400, 9000, 0, 0, 0,0,0,0,0,0, 0 },
+														{	2000, 2200, 2400, 2600, 2800, 3000, 3200, 3400, 9000, 0, 0, 0,0,0,0,0,0, 0 } } ;
 uint16_t Pulses2[18] = {	2000, 2200, 2400, 2600, 2800, 3000, 3200, 3400, 9000, 0, 0, 0,0,0,0,0,0, 0 } ;
 volatile uint32_t Pulses_index = 0 ;		// Modified in interrupt routine
 volatile uint32_t Pulses2_index = 0 ;		// Modified in interrupt routine
 
+// Three frame buffers, the interrupt sends PulsesFront while the mixer
+// builds the next frame in a spare one and publishes it as PulsesNext.
+// The interrupt then only has to swap, it builds a frame itself only if
+// nothing has been published and the mixer isn't part way through one.
+uint8_t PulsesLength[3] ;		// Serial bytes in each Bit_pulses frame
+uint8_t PulsesFront ;				// Frame being sent
+uint8_t PulsesBuild ;				// Frame the encoders write to
+volatile uint8_t PulsesNext ;				// Complete frame, valid when PulsesReady
+volatile uint8_t PulsesReady ;
+volatile uint8_t PulsesBuilding ;	// Mixer is building a frame, encoders in use
+
+uint16_t PulsesIsrTime[4] ;		// Worst case in setupPulses() per protocol, 2MHz ticks
+uint16_t PulsesBuildTime ;		// Last frame built by the mixer, 2MHz ticks
+uint16_t PulsesIsrBuilds ;		// Frames the interrupt had to build itself
+
+// Mixer to pulses latency, from the inputs being read to the frame being
+// swapped in, 2MHz ticks. With g_eeGeneral.mixerLead set the main task is
+// woken that long before each frame instead of running on its own 2mS tick.
+uint16_t MixerInputTime ;			// Set as the inputs are read
+uint16_t PulsesMixTime ;			// Inputs for the last mixer run built
+uint16_t PulsesInputTime[3] ;	// Inputs each frame was built from
+uint16_t PulsesFrameTime[3] ;	// PPM frame length, half uS
+uint16_t PulsesSwapTime ;
+uint16_t PulsesLead ;					// Lead for the current frame, half uS
+uint8_t PulsesSyncPhase ;			// PXX/DSM long period has been split
+uint8_t PulsesSynced ;				// Mixer woken for this frame
+uint16_t LatencyMin = 0xFFFF ;
+uint16_t LatencyMax ;
+uint32_t LatencySum ;
+uint32_t LatencyCount ;
+
+#ifndef SIMU
+extern OS_FlagID MixerFlag ;
+
+static void mixerSync()
+{
+	CoEnterISR() ; // Enter the interrupt
+	isr_SetFlag( MixerFlag ) ;		// Start the next mixer pass
+	CoExitISR() ; // Exit the interrupt
+}
+#endif
+
+// Mixer lead in half uS, at most 3.5mS so a split PXX period is never 2.5mS
+static uint16_t mixerLead()
+{
+	uint32_t lead = g_eeGeneral.mixerLead ;
+	if ( lead > 35 )
+	{
+		lead = 35 ;
+	}
+	return lead * 200 ;
+}
+
 // DSM2 control bits
 #define BindBit 0x80
 #define RangeCheckBit 0x20
@@ -145,7 +201,11 @@ void init_main_ppm( uint32_t period, uint32_t out_enable )
 	register Pwm *pwmptr ;
 	
   perOut(g_chans512, 0) ;
-  setupPulsesPPM() ;
+	if ( PulsesBuilding == 0 )
+	{
+		PulsesBuild = PulsesFront ;
+	  setupPulsesPPM() ;
+	}
 
 	if ( out_enable )
 	{
@@ -231,37 +291,54 @@ extern "C" void PWM_IRQHandler (void)
 		switch ( Current_protocol )		// Use the current, don't switch until set_up_pulses
 		{
       case PROTO_PPM:
-				pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = Pulses[Pulses_index++] ;	// Period in half uS
-				if ( Pulses[Pulses_index] == 0 )
+				pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = Pulses[PulsesFront][Pulses_index++] ;	// Period in half uS
+				if ( Pulses[PulsesFront][Pulses_index] == 0 )
 				{
 					Pulses_index = 0 ;
 
 					setupPulses() ;
 				}
+				else if ( PulsesLead && !PulsesSynced )
+				{
+					// Wake the mixer now if the period running ends past the lead point
+					period = (uint16_t)( getTmr2MHz() - PulsesSwapTime ) + pwmptr->PWM_CH_NUM[3].PWM_CPDR ;
+					if ( period + PulsesLead >= PulsesFrameTime[PulsesFront] )
+					{
+						PulsesSynced = 1 ;
+						mixerSync() ;
+					}
+				}
 			break ;
 
       case PROTO_PXX:
 				// Alternate periods of 6.5mS and 2.5 mS
+				// With a mixer lead, the 6.5mS ends with a period of the lead
 				period = pwmptr->PWM_CH_NUM[3].PWM_CPDR ;
-				if ( period == 5000 )	// 2.5 mS
+				if ( PulsesSyncPhase )
 				{
-					period = 6500*2 ;
-				}
-				else
-				{
-					period = 5000 ;	// 2.5 mS
+					PulsesSyncPhase = 0 ;
+					pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = 5000 ;	// 2.5 mS
+					mixerSync() ;
 				}
-				pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = period ;	// Period in half uS
-				if ( period != 5000 )	// 2.5 mS
+				else if ( period == 5000 )	// 2.5 mS
 				{
+					PulsesLead = mixerLead() ;
+					pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = 6500*2 - PulsesLead ;	// Period in half uS
 					setupPulses() ;
 				}
 				else
 				{
+					period = 5000 ;	// 2.5 mS
+					if ( PulsesLead )
+					{
+						period = PulsesLead ;
+						PulsesSyncPhase = 1 ;
+					}
+					pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = period ;	// Period in half uS
 					// Kick off serial output here
 					sscptr = SSC ;
-					sscptr->SSC_TPR = (uint32_t) Bit_pulses ;
-					sscptr->SSC_TCR = Serial_byte_count ;
+					sscptr->SSC_TPR = (uint32_t) Bit_pulses[PulsesFront] ;
+					sscptr->SSC_TCR = PulsesLength[PulsesFront] ;
 					sscptr->SSC_PTCR = SSC_PTCR_TXTEN ;	// Start transfers
 				}
 			break ;
@@ -269,8 +346,15 @@ extern "C" void PWM_IRQHandler (void)
       case PROTO_DSM2:
       case PROTO_ASSAN:
 				// Alternate periods of 19.5mS/8.5mS and 2.5 mS
+				// With a mixer lead, the 8.5mS ends with a period of the lead
 				period = pwmptr->PWM_CH_NUM[3].PWM_CPDR ;
-				if ( period == 5000 )	// 2.5 mS
+				if ( PulsesSyncPhase )
+				{
+					PulsesSyncPhase = 0 ;
+					pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = 5000 ;	// 2.5 mS
+					mixerSync() ;
+				}
+				else if ( period == 5000 )	// 2.5 mS
 				{
 //					if ( Dsm_9xr )
 //					{
@@ -280,18 +364,19 @@ extern "C" void PWM_IRQHandler (void)
 //					{
 //						period = 19500*2 ;
 //					}	 
-				}
-				else
-				{
-					period = 5000 ;
-				}
-				pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = period ;	// Period in half uS
-				if ( period != 5000 )	// 2.5 mS
-				{
+					PulsesLead = mixerLead() ;
+					pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = period - PulsesLead ;	// Period in half uS
 					setupPulses() ;
 				}
 				else
 				{
+					period = 5000 ;
+					if ( PulsesLead )
+					{
+						period = PulsesLead ;
+						PulsesSyncPhase = 1 ;
+					}
+					pwmptr->PWM_CH_NUM[3].PWM_CPDRUPD = period ;	// Period in half uS
 					// Kick off serial output here
 					if ( Current_protocol == PROTO_ASSAN )
 					{
@@ -301,8 +386,8 @@ extern "C" void PWM_IRQHandler (void)
 //						PIOA->PIO_PER = PIO_PA5 ;		// Assign A5 to PIO
 					}
 					sscptr = SSC ;
-					sscptr->SSC_TPR = (uint32_t) Bit_pulses ;
-					sscptr->SSC_TCR = Serial_byte_count ;
+					sscptr->SSC_TPR = (uint32_t) Bit_pulses[PulsesFront] ;
+					sscptr->SSC_TCR = PulsesLength[PulsesFront] ;
 					sscptr->SSC_PTCR = SSC_PTCR_TXTEN ;	// Start transfers
 					if ( Current_protocol == PROTO_ASSAN )
 					{
@@ -456,7 +541,7 @@ void setupPulsesDsm2(uint8_t chns)
 	Serial_byte = 0 ;
 	Serial_bit_count = 0 ;
 	Serial_byte_count = 0 ;
-  Pulses2MHzptr = Bit_pulses ;
+  Pulses2MHzptr = Bit_pulses[PulsesBuild] ;
     
 	if ( Dsm_9xr )
 	{
@@ -717,12 +802,118 @@ void startPulses()
 	pass = 0 ;			// Force a type 0 packet
 }
 
+// The encoders for the current protocol, writing to frame PulsesBuild
+static void encodePulses()
+{
+	switch(Current_protocol)
+  {
+	  case PROTO_PPM:
+      setupPulsesPPM();		// Don't enable interrupts through here
+    break;
+  	case PROTO_PXX:
+//      sei() ;							// Interrupts allowed here
+      setupPulsesPXX();
+    break;
+	  case PROTO_DSM2:
+//      sei() ;							// Interrupts allowed here
+      setupPulsesDsm2( ( g_model.sub_protocol == DSM_9XR ) ? 12 : 6 ) ; 
+    break;
+#ifdef ASSAN
+    case PROTO_ASSAN :
+      setupPulsesDsm2( 12 ) ;
+    break;
+#endif
+  }
+	PulsesLength[PulsesBuild] = Serial_byte_count ;
+	PulsesInputTime[PulsesBuild] = PulsesMixTime ;
+}
+
+static uint16_t dsmBaudrate()
+{
+#ifdef ASSAN
+	if ( g_model.protocol == PROTO_ASSAN )
+	{
+		return SCC_BAUD_115200 ;
+	}
+#endif
+	return ( g_model.sub_protocol == DSM_9XR ) ? SCC_BAUD_115200 : SCC_BAUD_125000 ;
+}
+
+// Called from the mixer task after a mixer run, so the next frame is
+// ready before the interrupt needs it. Only one frame is built for each
+// one sent, a frame still waiting for the interrupt is left as it is.
+void buildPulses()
+{
+	uint8_t protocol ;
+	uint8_t b ;
+	uint16_t t0 ;
+
+	if ( PulsesReady )
+	{
+		return ;		// Only the interrupt clears this
+	}
+	PulsesMixTime = MixerInputTime ;		// Inputs of the outputs now in g_chans512
+	protocol = Current_protocol ;
+	if ( protocol != g_model.protocol )
+	{
+		return ;		// Changing, the interrupt sets up the hardware
+	}
+#ifdef ASSAN
+	if ( ( protocol == PROTO_DSM2 ) || ( protocol == PROTO_ASSAN ) )
+#else
+	if ( protocol == PROTO_DSM2 )
+#endif
+	{
+		if ( dsmBaudrate() != Scc_baudrate )
+		{
+			return ;		// Leave the SSC change to the interrupt
+		}
+	}
+
+	__disable_irq() ;
+	b = PulsesFront + 1 ;
+	if ( b > 2 )
+	{
+		b = 0 ;
+	}
+	if ( b == PulsesNext )
+	{
+		if ( ++b > 2 )
+		{
+			b = 0 ;
+		}
+	}
+	PulsesBuild = b ;
+	PulsesBuilding = 1 ;
+	__enable_irq() ;
+
+	t0 = getTmr2MHz() ;
+	encodePulses() ;
+	PulsesBuildTime = getTmr2MHz() - t0 ;
+
+	__disable_irq() ;
+	// Drop it if the protocol changed meanwhile
+	if ( Current_protocol == protocol )
+	{
+		PulsesNext = b ;
+		PulsesReady = 1 ;
+	}
+	PulsesBuilding = 0 ;
+	__enable_irq() ;
+}
+
 void setupPulses()
 {
+	uint16_t t0 ;
+	uint32_t changed = 0 ;
   heartbeat |= HEART_TIMER_PULSES ;
 	
   if ( Current_protocol != g_model.protocol )
   {
+		PulsesReady = 0 ;								// Built for the old protocol
+		PulsesLength[PulsesFront] = 0 ;	// Nothing to send until rebuilt
+		PulsesSyncPhase = 0 ;
+		changed = 1 ;
     switch( Current_protocol )
     {	// stop existing protocol hardware
       case PROTO_PPM:
@@ -767,32 +958,68 @@ void setupPulses()
   }
 
 // Set up output data here
-	switch(Current_protocol)
-  {
-	  case PROTO_PPM:
-      setupPulsesPPM();		// Don't enable interrupts through here
-    break;
-  	case PROTO_PXX:
-//      sei() ;							// Interrupts allowed here
-      setupPulsesPXX();
-    break;
-	  case PROTO_DSM2:
-//      sei() ;							// Interrupts allowed here
-      setupPulsesDsm2( ( g_model.sub_protocol == DSM_9XR ) ? 12 : 6 ) ; 
-    break;
-#ifdef ASSAN
-    case PROTO_ASSAN :
-      setupPulsesDsm2( 12 ) ;
-    break;
-#endif
-  }
+	t0 = getTmr2MHz() ;
+	if ( PulsesReady )
+	{
+		PulsesFront = PulsesNext ;		// Send the frame the mixer built
+		PulsesReady = 0 ;
+	}
+	else if ( PulsesBuilding == 0 )
+	{
+		PulsesBuild = PulsesFront ;		// Mixer is late, build in place as before
+		encodePulses() ;
+		PulsesIsrBuilds += 1 ;
+	}
+	// else the mixer is part way through the next one, send this again
+
+	if ( Current_protocol == PROTO_PPM )
+	{
+		setupPulsesPPMoutput() ;
+		PulsesLead = mixerLead() ;
+	}
+	PulsesSwapTime = t0 ;
+	PulsesSynced = 0 ;
+	if ( changed == 0 )
+	{
+		uint16_t latency = t0 - PulsesInputTime[PulsesFront] ;
+		if ( latency < LatencyMin )
+		{
+			LatencyMin = latency ;
+		}
+		if ( latency > LatencyMax )
+		{
+			LatencyMax = latency ;
+		}
+		LatencySum += latency ;
+		LatencyCount += 1 ;
+	}
+	t0 = getTmr2MHz() - t0 ;
+	if ( t0 > PulsesIsrTime[Current_protocol & 3] )
+	{
+		PulsesIsrTime[Current_protocol & 3] = t0 ;	// Worst case, cleared from the statistics menu
+	}
 }
 
-void setupPulsesPPM()			// Don't enable interrupts through here
+// Stop length and polarity, written as the frame is swapped in
+void setupPulsesPPMoutput()
 {
 	register Pwm *pwmptr ;
 	
 	pwmptr = PWM ;
+	pwmptr->PWM_CH_NUM[3].PWM_CDTYUPD = (g_model.ppmDelay*50+300)*2; //Stoplen *2
+	
+	if (g_model.pulsePol == 0)
+	{
+		pwmptr->PWM_CH_NUM[3].PWM_CMR |= 0x00000200 ;	// CPOL
+	}
+	else
+	{
+		pwmptr->PWM_CH_NUM[3].PWM_CMR &= ~0x00000200 ;	// CPOL
+	}
+}
+
+void setupPulsesPPM()			// Don't enable interrupts through here
+{
 	// Now set up pulses
 #define PPM_CENTER 1500*2
 	int16_t PPM_range = g_model.extendedLimits ? 640*2 : 512*2;   //range of 0.7..1.7msec
@@ -801,7 +1028,7 @@ void setupPulsesPPM()			// Don't enable interrupts through here
   //each pulse is 0.7..1.7ms long with a 0.3ms stop tail
   //The pulse ISR is 2mhz that's why everything is multiplied by 2
   uint16_t *ptr ;
-  ptr = Pulses ;
+  ptr = Pulses[PulsesBuild] ;
 	uint32_t p = (g_model.ppmNCH + 4) * 2 ;
 	if ( p > 16 )
 	{
@@ -813,24 +1040,15 @@ void setupPulsesPPM()			// Don't enable interrupts through here
 		p = NUM_SKYCHNOUT ;	// Don't run off the end		
 	}
     
-	pwmptr->PWM_CH_NUM[3].PWM_CDTYUPD = (g_model.ppmDelay*50+300)*2; //Stoplen *2
-	
-	if (g_model.pulsePol == 0)
-	{
-		pwmptr->PWM_CH_NUM[3].PWM_CMR |= 0x00000200 ;	// CPOL
-	}
-	else
-	{
-		pwmptr->PWM_CH_NUM[3].PWM_CMR &= ~0x00000200 ;	// CPOL
-	}
-    
 	uint16_t rest=22500u*2; //Minimum Framelen=22.5 ms
+	uint32_t frame = 0 ;
   rest += (int16_t(g_model.ppmFrameLength))*1000;
   //    if(p>9) rest=p*(1720u*2 + q) + 4000u*2; //for more than 9 channels, frame must be longer
   for(uint32_t i=g_model.startChannel;i<p;i++)
 	{ //NUM_SKYCHNOUT
   	int16_t v = max( (int)min(g_chans512[i],PPM_range),-PPM_range) + PPM_CENTER;
    	rest-=(v);
+		frame += v ;
 	//        *ptr++ = q;      //moved down two lines
     	    //        pulses2MHz[j++] = q;
     *ptr++ = v ; /* as Pat MacKenzie suggests */
@@ -845,6 +1063,8 @@ void setupPulsesPPM()			// Don't enable interrupts through here
 	}
  	*ptr = rest;
  	*(ptr+1) = 0;
+	frame += rest ;
+	PulsesFrameTime[PulsesBuild] = ( frame > 0xFFFF ) ? 0xFFFF : frame ;	// For the mixer lead
 }
 
 
@@ -965,6 +1185,26 @@ const uint16_t CRCTable[]=
 
 uint16_t PcmCrc ;
 uint8_t PcmOnesCount ;
+uint32_t PcmBits ;				// Line bits not yet a whole byte, next in bit 0
+uint8_t PcmBitCount ;
+
+// Line bits for a nibble sent MSB first with bit stuffing, 01 for a 0 and
+// 001 for a 1, with a 0 stuffed after five 1s. Indexed by [ones already
+// sent][nibble], bits 0-13 are the line bits (first in bit 0), bits 16-20
+// the bit count and bits 24-26 the ones count afterwards.
+const uint32_t PcmStuffTable[5][16] =
+{
+	{ 0x000800aa,0x0109012a,0x0009014a,0x020a024a,0x00090152,0x010a0252,0x000a0292,0x030b0492,
+	  0x00090154,0x010a0254,0x000a0294,0x020b0494,0x000a02a4,0x010b04a4,0x000b0524,0x040c0924 },
+	{ 0x000800aa,0x0109012a,0x0009014a,0x020a024a,0x00090152,0x010a0252,0x000a0292,0x030b0492,
+	  0x00090154,0x010a0254,0x000a0294,0x020b0494,0x000a02a4,0x010b04a4,0x000b0524,0x000e2924 },
+	{ 0x000800aa,0x0109012a,0x0009014a,0x020a024a,0x00090152,0x010a0252,0x000a0292,0x030b0492,
+	  0x00090154,0x010a0254,0x000a0294,0x020b0494,0x000a02a4,0x010b04a4,0x000d1524,0x010e2524 },
+	{ 0x000800aa,0x0109012a,0x0009014a,0x020a024a,0x00090152,0x010a0252,0x000a0292,0x030b0492,
+	  0x00090154,0x010a0254,0x000a0294,0x020b0494,0x000c0aa4,0x010d12a4,0x000d14a4,0x020e24a4 },
+	{ 0x000800aa,0x0109012a,0x0009014a,0x020a024a,0x00090152,0x010a0252,0x000a0292,0x030b0492,
+	  0x000b0554,0x010c0954,0x000c0a54,0x020d1254,0x000c0a94,0x010d1294,0x000d1494,0x030e2494 }
+} ;
 
 void crc( uint8_t data )
 {
@@ -974,69 +1214,62 @@ void crc( uint8_t data )
 }
 
 
+// Append count line bits, first in bit 0, 8uS/bit
+void putPcmBits( uint32_t bits, uint32_t count )
+{
+	bits = ( bits << PcmBitCount ) | PcmBits ;
+	count += PcmBitCount ;
+	while ( count >= 8 )
+	{
+    *Pulses2MHzptr++ = bits ;
+		Serial_byte_count += 1 ;
+		bits >>= 8 ;
+		count -= 8 ;
+	}
+	PcmBits = bits ;
+	PcmBitCount = count ;
+}
+
 // 8uS/bit 01 = 0, 001 = 1
 void putPcmPart( uint8_t value )
 {
-	put_serial_bit( 0 ) ; 
 	if ( value )
 	{
-		put_serial_bit( 0 ) ;
+		putPcmBits( 0x04, 3 ) ;
+	}
+	else
+	{
+		putPcmBits( 0x02, 2 ) ;
 	}
-	put_serial_bit( 1 ) ;
 }
 
 
 void putPcmFlush()
 {
-  while ( Serial_bit_count != 0 )
+  if ( PcmBitCount != 0 )
 	{
-		put_serial_bit( 1 ) ;		// Line idle level
+		putPcmBits( 0xFF >> PcmBitCount, 8 - PcmBitCount ) ;		// Line idle level
   }
 }
 
-void putPcmBit( uint8_t bit )
-{
-    if ( bit )
-    {
-        PcmOnesCount += 1 ;
-        putPcmPart( 1 ) ;
-    }
-    else
-    {
-        PcmOnesCount = 0 ;
-        putPcmPart( 0 ) ;
-    }
-    if ( PcmOnesCount >= 5 )
-    {
-        putPcmBit( 0 ) ;				// Stuff a 0 bit in
-    }
-}
-
 void putPcmByte( uint8_t byte )
 {
-    uint8_t i ;
+	uint32_t x ;
 
-    crc( byte ) ;
+  crc( byte ) ;
 
-    for ( i = 0 ; i < 8 ; i += 1 )
-    {
-        putPcmBit( byte & 0x80 ) ;
-        byte <<= 1 ;
-    }
+	x = PcmStuffTable[PcmOnesCount][byte >> 4] ;
+	putPcmBits( x & 0x3FFF, ( x >> 16 ) & 0x1F ) ;
+	x = PcmStuffTable[x >> 24][byte & 0x0F] ;
+	putPcmBits( x & 0x3FFF, ( x >> 16 ) & 0x1F ) ;
+	PcmOnesCount = x >> 24 ;
 }
 
 void putPcmHead()
 {
     // send 7E, do not CRC
     // 01111110
-    putPcmPart( 0 ) ;
-    putPcmPart( 1 ) ;
-    putPcmPart( 1 ) ;
-    putPcmPart( 1 ) ;
-    putPcmPart( 1 ) ;
-    putPcmPart( 1 ) ;
-    putPcmPart( 1 ) ;
-    putPcmPart( 0 ) ;
+	putPcmBits( 0x292492, 22 ) ;
 }
 
 uint16_t scaleForPXX( uint8_t i )
@@ -1062,10 +1295,10 @@ void setupPulsesPXX()
     uint16_t chan_1 ;
 		uint8_t lpass = pass ;
 
-		Serial_byte = 0 ;
-		Serial_bit_count = 0 ;
+		PcmBits = 0 ;
+		PcmBitCount = 0 ;
 		Serial_byte_count = 0 ;
-	  Pulses2MHzptr = Bit_pulses ;
+	  Pulses2MHzptr = Bit_pulses[PulsesBuild] ;
     PcmCrc = 0 ;
     PcmOnesCount = 0 ;
     putPcmPart( 0 ) ;
@@ -66,6 +66,9 @@ extern void perOut( int16_t *chanOut, uint8_t att ) ;
 extern void startPulses( void ) ;
 extern void setupPulses( void ) ;
 extern void setupPulsesPPM( void ) ;
+extern void setupPulsesPPMoutput( void ) ;
+extern void buildPulses( void ) ;
+extern uint16_t MixerInputTime ;
 extern void setupPulsesPPM2( void ) ;
 extern void setupPulsesDsm2(uint8_t chns) ;
 extern void setupPulsesPXX( void ) ;
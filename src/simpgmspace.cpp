@@ -227,4 +227,10 @@ void disable_main_ppm()
 {
 }
 
+void buildPulses()
+{
+}
+
+uint16_t MixerInputTime ;
+
 uint8_t pxxFlag = 0 ;
@@ -82,6 +82,12 @@ uint32_t SpeedAllowed ;
 
 uint32_t Sd_retries ;
 
+// Transfer counts, blocks per command shows what multi-block saves
+uint32_t SdReadCommands ;
+uint32_t SdReadBlocks ;
+uint32_t SdWriteCommands ;
+uint32_t SdWriteBlocks ;
+
 /*-----------------------------------------------------------------------*/
 /* Lock / unlock functions                                               */
 /*-----------------------------------------------------------------------*/
@@ -431,6 +437,22 @@ uint32_t sd_cmd7()
                                      | HSMCI_CMDR_TRTYP_SINGLE \
                                      | HSMCI_CMDR_MAXLAT)
 
+#define SD_READ_MULTIPLE_BLOCK   (18 | HSMCI_CMDR_SPCMD_STD | HSMCI_CMDR_RSPTYP_48_BIT \
+                                     | HSMCI_CMDR_TRCMD_START_DATA | HSMCI_CMDR_TRDIR_READ \
+                                     | HSMCI_CMDR_TRTYP_MULTIPLE | HSMCI_CMDR_MAXLAT)
+
+#define SD_WRITE_MULTIPLE_BLOCK  (25 | HSMCI_CMDR_SPCMD_STD \
+                                     | HSMCI_CMDR_RSPTYP_48_BIT \
+                                     | HSMCI_CMDR_TRCMD_START_DATA \
+                                     | HSMCI_CMDR_TRDIR_WRITE \
+                                     | HSMCI_CMDR_TRTYP_MULTIPLE \
+                                     | HSMCI_CMDR_MAXLAT)
+
+#define SD_STOP_TRANSMISSION     (12 | HSMCI_CMDR_SPCMD_STD \
+                                     | HSMCI_CMDR_RSPTYP_R1B \
+                                     | HSMCI_CMDR_TRCMD_STOP_DATA \
+                                     | HSMCI_CMDR_MAXLAT)
+
 // Get SCR
 uint32_t sd_acmd51( uint32_t *presult )
 {
@@ -668,7 +690,27 @@ uint32_t sd_cmd16()
 //#endif
 }
 
-uint32_t sd_read_block(uint32_t block_no, uint32_t *data)
+// Wait for the card to finish a transfer, checking first without a delay
+static uint32_t sd_wait_status( uint32_t mask, uint32_t retry )
+{
+  Hsmci *phsmci = HSMCI;
+
+	for(;;)
+	{
+		if ( ( phsmci->HSMCI_SR & mask ) == mask )
+		{
+			return 1 ;
+		}
+		if ( retry-- == 0 )
+		{
+			return 0 ;
+		}
+    CoTickDelay(1); // 2ms
+	}
+}
+
+// Read count consecutive blocks, using CMD18 when count > 1
+uint32_t sd_read_blocks( uint32_t block_no, uint32_t *data, uint32_t count )
 {
   uint32_t result = 0;
   Hsmci *phsmci = HSMCI;
@@ -684,33 +726,46 @@ uint32_t sd_read_block(uint32_t block_no, uint32_t *data)
     } while (((status & STATUS_READY_FOR_DATA) == 0)
           || ((status & STATUS_STATE) != STATUS_TRAN) );
 		
-    // Block size = 512, nblocks = 1
-    phsmci->HSMCI_BLKR = ((512) << 16) | 1;
+    // Block size = 512, nblocks = count
+    phsmci->HSMCI_BLKR = ((512) << 16) | count;
     phsmci->HSMCI_MR   = (phsmci->HSMCI_MR & (~(HSMCI_MR_BLKLEN_Msk|HSMCI_MR_FBYTE))) | (HSMCI_MR_PDCMODE|HSMCI_MR_WRPROOF|HSMCI_MR_RDPROOF) | (512 << 16);
     phsmci->HSMCI_ARGR = Cmd_A41_resp & 0x40000000 ? block_no : block_no << 9;
     phsmci->HSMCI_RPR  = CONVERT_PTR(data);
-    phsmci->HSMCI_RCR  = 512 / 4;
+    phsmci->HSMCI_RCR  = count * 512 / 4;
     phsmci->HSMCI_PTCR = HSMCI_PTCR_RXTEN;
-    phsmci->HSMCI_CMDR = SD_READ_SINGLE_BLOCK;
+    phsmci->HSMCI_CMDR = ( count > 1 ) ? SD_READ_MULTIPLE_BLOCK : SD_READ_SINGLE_BLOCK ;
+		SdReadCommands += 1 ;
         
-    uint8_t retry = 100;
-    while (retry-- > 0)
+		if ( count > 1 )
 		{
-      CoTickDelay(1); // 2ms
-      if (phsmci->HSMCI_SR & HSMCI_SR_ENDRX)
+	    result = sd_wait_status( HSMCI_SR_ENDRX | HSMCI_SR_XFRDONE, 100 + count ) ;
+			sdCommand( SD_STOP_TRANSMISSION, 0 ) ;
+			if ( sd_wait_status( HSMCI_SR_NOTBUSY, 100 ) == 0 )
 			{
-//      		phsmci->HSMCI_PTCR = HSMCI_PTCR_RXTDIS;
-        result = 1;
-        break;
-      }
-    }
+				result = 0 ;
+			}
+		}
+		else
+		{
+	    result = sd_wait_status( HSMCI_SR_ENDRX, 100 ) ;
+		}
+		if ( result )
+		{
+			SdReadBlocks += count ;
+		}
   }
 	phsmci->HSMCI_PTCR = HSMCI_PTCR_RXTDIS;
   phsmci->HSMCI_MR &= ~HSMCI_MR_PDCMODE;
   return result;
 }
 
-uint32_t sd_write_block( uint32_t block_no, uint32_t *data )
+uint32_t sd_read_block(uint32_t block_no, uint32_t *data)
+{
+	return sd_read_blocks( block_no, data, 1 ) ;
+}
+
+// Write count consecutive blocks, using CMD25 when count > 1
+uint32_t sd_write_blocks( uint32_t block_no, uint32_t *data, uint32_t count )
 {
   uint32_t result = 0;
   Hsmci *phsmci = HSMCI;
@@ -725,25 +780,35 @@ uint32_t sd_write_block( uint32_t block_no, uint32_t *data )
     } while (((status & STATUS_READY_FOR_DATA) == 0)
           || ((status & STATUS_STATE) != STATUS_TRAN) );
     
-		// Block size = 512, nblocks = 1
-    phsmci->HSMCI_BLKR = ((512) << 16) | 1;
+		// Block size = 512, nblocks = count
+    phsmci->HSMCI_BLKR = ((512) << 16) | count;
     phsmci->HSMCI_MR   = (phsmci->HSMCI_MR & (~(HSMCI_MR_BLKLEN_Msk|HSMCI_MR_FBYTE))) | (HSMCI_MR_PDCMODE|HSMCI_MR_WRPROOF|HSMCI_MR_RDPROOF) | (512 << 16);
     phsmci->HSMCI_ARGR = Cmd_A41_resp & 0x40000000 ? block_no : block_no << 9;
     phsmci->HSMCI_TPR  = CONVERT_PTR(data);
-    phsmci->HSMCI_TCR  = 512 / 4;
-    phsmci->HSMCI_CMDR = SD_WRITE_SINGLE_BLOCK;
+    phsmci->HSMCI_TCR  = count * 512 / 4;
+    phsmci->HSMCI_CMDR = ( count > 1 ) ? SD_WRITE_MULTIPLE_BLOCK : SD_WRITE_SINGLE_BLOCK ;
     phsmci->HSMCI_PTCR = HSMCI_PTCR_TXTEN;
+		SdWriteCommands += 1 ;
       
-    uint8_t retry = 100;
-    while (retry-- > 0) {
-      CoTickDelay(1); // 2ms
-			if (phsmci->HSMCI_SR & HSMCI_SR_NOTBUSY)
+		if ( count > 1 )
+		{
+			// All data sent, then stop the card and let it finish programming
+	    result = sd_wait_status( HSMCI_SR_ENDTX | HSMCI_SR_XFRDONE, 100 + count ) ;
+			sdCommand( SD_STOP_TRANSMISSION, 0 ) ;
+			if ( sd_wait_status( HSMCI_SR_NOTBUSY, 100 ) == 0 )
 			{
-//      		phsmci->HSMCI_PTCR = HSMCI_PTCR_TXTDIS;
-        result = 1;
-        break;
-      }
-    }
+				result = 0 ;
+			}
+		}
+		else
+		{
+	    CoTickDelay(1); // 2ms
+	    result = sd_wait_status( HSMCI_SR_NOTBUSY, 99 ) ;
+		}
+		if ( result )
+		{
+			SdWriteBlocks += count ;
+		}
   }
 
 	phsmci->HSMCI_PTCR = HSMCI_PTCR_TXTDIS;
@@ -751,6 +816,11 @@ uint32_t sd_write_block( uint32_t block_no, uint32_t *data )
   return result;
 }
 
+uint32_t sd_write_block( uint32_t block_no, uint32_t *data )
+{
+	return sd_write_blocks( block_no, data, 1 ) ;
+}
+
 /*
  Notes on SD card:
 
@@ -946,18 +1016,10 @@ DRESULT disk_read (
 
 		if ( sd_card_ready() == 0 ) return RES_NOTRDY;
 
-    do {
-      result = sd_read_block( sector, ( uint32_t *)buff ) ;
-      if (result) {
-        sector += 1 ;
-        buff += 512 ;
-        count -= 1 ;
-      }
-      else {
-        count = 1 ;             // Flag error
-        break ;
-      }
-    } while ( count ) ;
+    result = sd_read_blocks( sector, ( uint32_t *)buff, count ) ;
+    if (result) {
+      count = 0 ;
+    }
 	}
   return count ? RES_ERROR : RES_OK;
 }
@@ -985,18 +1047,10 @@ DRESULT disk_write (
 
     // TODO if (Stat & STA_PROTECT) return RES_WRPRT;
 
-    do {
-      result = sd_write_block( sector, ( uint32_t *)buff ) ;
-      if (result) {
-        sector += 1 ;
-        buff += 512 ;
-        count -= 1 ;
-      }
-      else {
-        count = 1 ;             // Flag error
-        break ;
-      }
-    } while ( count ) ;
+    result = sd_write_blocks( sector, ( uint32_t *)buff, count ) ;
+    if (result) {
+      count = 0 ;
+    }
 	}
   return count ? RES_ERROR : RES_OK;
 }
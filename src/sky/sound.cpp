@@ -365,9 +365,12 @@ extern "C" void DAC_IRQHandler()
 // Data for PDC must NOT be in flash, PDC needs a RAM source.
 	if ( Sound_g.VoiceActive == 1 )
 	{
+		uint32_t i ;
 		PtrVoiceBuffer[0]->flags |= VF_SENT ;		// Flag sent
-		PtrVoiceBuffer[0] = PtrVoiceBuffer[1] ;
-		PtrVoiceBuffer[1] = PtrVoiceBuffer[2] ;
+		for ( i = 1 ; i < NUM_VOICE_BUFFERS ; i += 1 )
+		{
+			PtrVoiceBuffer[i-1] = PtrVoiceBuffer[i] ;
+		}
 		 
 		if ( DACC->DACC_ISR & DACC_ISR_TXBUFE )
 		{
@@ -463,7 +466,7 @@ void sound_5ms()
 		{
 			// audioOn() ;
 			dacptr->DACC_IDR = DACC_IDR_ENDTX ;	// Disable interrupt
-			Sound_g.Sound_time = 0 ;						// Remove any pending tone requests
+			mixToneRequest() ;						// Pending tone is mixed with the voice
 			if ( dacptr->DACC_ISR & DACC_ISR_TXBUFE )	// All sent
 			{
 				// Now we can send the voice file
@@ -490,7 +493,7 @@ void sound_5ms()
 		
 		if ( ( Sound_g.VoiceActive ) || ( ( Voice.VoiceQueueCount ) && sd_card_ready() ) )
 		{
-			Sound_g.Sound_time = 0 ;						// Remove any pending tone requests
+			mixToneRequest() ;						// Pending tone is mixed with the voice
 			return ;
 		}
 				
@@ -538,16 +541,48 @@ void sound_5ms()
 }
 
 
+// Converts 4 samples per pass using word loads and stores, src and dest
+// must be word aligned for this, otherwise (and for the tail) 1 at a time
 void wavU8Convert( uint8_t *src, uint16_t *dest , uint32_t count )
 {
+	if ( ( ( (uint32_t)src | (uint32_t)dest ) & 3 ) == 0 )
+	{
+		uint32_t *s = (uint32_t *)src ;
+		uint32_t *d = (uint32_t *)dest ;
+		uint32_t x ;
+		while ( count >= 4 )
+		{
+			x = *s++ ;
+			*d++ = ( ( x & 0x000000FF ) << 4 ) | ( ( x & 0x0000FF00 ) << 12 ) ;
+			*d++ = ( ( x >> 12 ) & 0x00000FF0 ) | ( ( x >> 4 ) & 0x0FF00000 ) ;
+			count -= 4 ;
+		}
+		src = (uint8_t *)s ;
+		dest = (uint16_t *)d ;
+	}
 	while( count-- )
 	{
 		*dest++ = *src++ << 4 ;
 	}
 }
 
+// Signed to offset binary is just flipping the top bit, done for
+// 2 samples in each word
 void wavU16Convert( uint16_t *src, uint16_t *dest , uint32_t count )
 {
+	if ( ( ( (uint32_t)src | (uint32_t)dest ) & 3 ) == 0 )
+	{
+		uint32_t *s = (uint32_t *)src ;
+		uint32_t *d = (uint32_t *)dest ;
+		while ( count >= 4 )
+		{
+			*d++ = ( ( *s++ ^ 0x80008000 ) >> 4 ) & 0x0FFF0FFF ;
+			*d++ = ( ( *s++ ^ 0x80008000 ) >> 4 ) & 0x0FFF0FFF ;
+			count -= 4 ;
+		}
+		src = (uint16_t *)s ;
+		dest = (uint16_t *)d ;
+	}
 	while( count-- )
 	{
 		*dest++ = (uint16_t)( (int16_t )*src++ + 32768) >> 4 ;
@@ -138,6 +138,9 @@ struct t_sound_globals
 	uint8_t toneLock ;
 	uint8_t VoiceActive ;
 	uint8_t VoiceRequest ;
+	uint32_t MixFreq ;
+	uint32_t MixIncrement ;
+	volatile uint16_t MixTime ;		// 10mS units, tone to mix with the voice
 //	uint8_t VoiceEnded ;
 } ;
 
@@ -147,7 +150,13 @@ struct t_sound_globals
 #define VF_LAST			0x02
 
 #define	VOICE_BUFFER_SIZE		512
-#define NUM_VOICE_BUFFERS		3
+
+// Levels in 16ths used when a tone is mixed with a voice file
+#define MIX_TONE_GAIN				16
+#define MIX_DUCK_GAIN				8			// Voice level while the tone sounds
+#ifndef NUM_VOICE_BUFFERS
+#define NUM_VOICE_BUFFERS		4			// 1K bytes of RAM each
+#endif
 
 struct t_VoiceBuffer
 {
@@ -82,9 +82,12 @@ SKYMixData* setDest(uint8_t dch)
     return &g_model.mixData[i];
 }
 
+extern void invalidateMixPlan( void ) ;
+
 void clearMixes()
 {
     memset(g_model.mixData,0,sizeof(g_model.mixData)); //clear all mixes
+		invalidateMixPlan() ;
 }
 
 void clearCurves()
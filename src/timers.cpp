@@ -679,6 +679,24 @@ const uint16_t CRCTable[]=
 };
 
 
+// Line parts for a nibble sent MSB first with bit stuffing, a 0 stuffed
+// after five 1s. Indexed by [ones already sent][nibble], bits 0-4 are the
+// parts (1 for a long part, first in bit 0), bits 8-10 the part count and
+// bits 12-14 the ones count afterwards.
+const uint16_t PcmStuffParts[5][16] =
+{
+	{ 0x0400,0x1408,0x0404,0x240c,0x0402,0x140a,0x0406,0x340e,
+	  0x0401,0x1409,0x0405,0x240d,0x0403,0x140b,0x0407,0x440f },
+	{ 0x0400,0x1408,0x0404,0x240c,0x0402,0x140a,0x0406,0x340e,
+	  0x0401,0x1409,0x0405,0x240d,0x0403,0x140b,0x0407,0x050f },
+	{ 0x0400,0x1408,0x0404,0x240c,0x0402,0x140a,0x0406,0x340e,
+	  0x0401,0x1409,0x0405,0x240d,0x0403,0x140b,0x0507,0x1517 },
+	{ 0x0400,0x1408,0x0404,0x240c,0x0402,0x140a,0x0406,0x340e,
+	  0x0401,0x1409,0x0405,0x240d,0x0503,0x1513,0x050b,0x251b },
+	{ 0x0400,0x1408,0x0404,0x240c,0x0402,0x140a,0x0406,0x340e,
+	  0x0501,0x1511,0x0509,0x2519,0x0505,0x1515,0x050d,0x351d }
+} ;
+
 uint16_t PcmCrc ;
 uint8_t PcmOnesCount ;
 
@@ -710,37 +728,28 @@ void putPcmFlush()
 }
 
 
-void putPcmBit( uint8_t bit )
-{
-    if ( bit )
-    {
-        PcmOnesCount += 1 ;
-        putPcmPart( 1 ) ;
-    }
-    else
-    {
-        PcmOnesCount = 0 ;
-        putPcmPart( 0 ) ;
-    }
-    if ( PcmOnesCount >= 5 )
-    {
-        putPcmBit( 0 ) ;				// Stuff a 0 bit in
-    }
-}
-
-
-
+// Each nibble from the table, no per bit stuffing decisions
 void putPcmByte( uint8_t byte )
 {
-    uint8_t i ;
+	uint32_t x ;
+	uint32_t n ;
 
-    crc( byte ) ;
+  crc( byte ) ;
 
-    for ( i = 0 ; i < 8 ; i += 1 )
-    {
-        putPcmBit( byte & 0x80 ) ;
-        byte <<= 1 ;
-    }
+	x = PcmStuffParts[PcmOnesCount][byte >> 4] ;
+	PcmOnesCount = x >> 12 ;
+	for ( n = ( x >> 8 ) & 7 ; n ; n -= 1 )
+	{
+		putPcmPart( x & 1 ) ;
+		x >>= 1 ;
+	}
+	x = PcmStuffParts[PcmOnesCount][byte & 0x0F] ;
+	PcmOnesCount = x >> 12 ;
+	for ( n = ( x >> 8 ) & 7 ; n ; n -= 1 )
+	{
+		putPcmPart( x & 1 ) ;
+		x >>= 1 ;
+	}
 }
 
 
@@ -790,37 +799,28 @@ void putPcmFlush_x()
 }
 
 
-void putPcmBit_x( uint8_t bit )
-{
-    if ( bit )
-    {
-        PcmOnesCount_x += 1 ;
-        putPcmPart_x( 1 ) ;
-    }
-    else
-    {
-        PcmOnesCount_x = 0 ;
-        putPcmPart_x( 0 ) ;
-    }
-    if ( PcmOnesCount_x >= 5 )
-    {
-        putPcmBit_x( 0 ) ;				// Stuff a 0 bit in
-    }
-}
-
-
-
+// Each nibble from the table, no per bit stuffing decisions
 void putPcmByte_x( uint8_t byte )
 {
-    uint8_t i ;
+	uint32_t x ;
+	uint32_t n ;
 
-    crc_x( byte ) ;
+  crc_x( byte ) ;
 
-    for ( i = 0 ; i < 8 ; i += 1 )
-    {
-        putPcmBit_x( byte & 0x80 ) ;
-        byte <<= 1 ;
-    }
+	x = PcmStuffParts[PcmOnesCount_x][byte >> 4] ;
+	PcmOnesCount_x = x >> 12 ;
+	for ( n = ( x >> 8 ) & 7 ; n ; n -= 1 )
+	{
+		putPcmPart_x( x & 1 ) ;
+		x >>= 1 ;
+	}
+	x = PcmStuffParts[PcmOnesCount_x][byte & 0x0F] ;
+	PcmOnesCount_x = x >> 12 ;
+	for ( n = ( x >> 8 ) & 7 ; n ; n -= 1 )
+	{
+		putPcmPart_x( x & 1 ) ;
+		x >>= 1 ;
+	}
 }
 
 